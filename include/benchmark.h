@@ -0,0 +1,79 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "matrix_operations.h"
+#include "dispatcher.h"
+#include "perf_counters.h"
+
+// Upper bound on timed runs per engine; benchmark_runs is clamped to it.
+#define BENCH_MAX_RUNS 1000
+
+// Largest |x - ref| / max|ref| still accepted as agreeing with the
+// sequential result. Engines sum in different orders, so allow rounding.
+#define BENCH_VERIFY_TOLERANCE 1e-9
+
+// Summary of the timed runs of one engine. Times are wall-clock seconds;
+// percentiles interpolate linearly between sorted runs.
+typedef struct {
+    int runs;
+    double min;
+    double p10;
+    double median;
+    double p90;
+    double max;
+    double mean;
+    double gflops;  // useful flops of the operation / median
+    double gbps;    // compulsory bytes (operands read, result written) / median
+    perf_sample_t counters;  // hardware counts per timed run, inactive without perf
+} bench_stats_t;
+
+typedef struct {
+    engine_t engine;
+    int ok;              // every run produced a result
+    int verified;        // agrees with the sequential engine (always 1 for it)
+    double error;        // relative difference from the sequential result
+    double speedup;      // sequential median / this median
+    bench_stats_t stats;
+} bench_result_t;
+
+// What one run produced: a matrix, or a vector of scalars (a determinant,
+// eigenvalues). Kept from the last run so engines can be cross-checked.
+typedef struct {
+    matrix_t* matrix;
+    double* values;
+    int count;
+} bench_output_t;
+
+// Performs the measured operation once. Returns 0 and fills *output on
+// success, -1 on failure.
+typedef int (*bench_run_fn)(void* context, bench_output_t* output);
+
+// Engines compared by benchmark_operation, in report order.
+#define BENCH_ENGINES 3
+
+// warmup untimed calls of run, then runs timed ones summarized into
+// *stats, with hardware counters read around the timed batch. The output of the last successful call is left in *last.
+// Returns the number of timed calls that succeeded.
+int benchmark_repeat(bench_run_fn run, void* context, int warmup, int runs,
+                     double flops, double bytes, bench_stats_t* stats, bench_output_t* last);
+
+// Times op on the sequential, process-pool and OpenMP engines: warmup
+// untimed runs, then runs timed ones each, B being NULL for the
+// determinant. Fills results[BENCH_ENGINES]. Returns 0, or -1 if the
+// sequential reference could not be computed.
+int benchmark_operation(dispatch_op_t op, const matrix_t* A, const matrix_t* B,
+                        int warmup, int runs, bench_result_t* results);
+
+// Useful flops and compulsory bytes of op, the basis of GFLOP/s and GB/s.
+void benchmark_operation_size(dispatch_op_t op, const matrix_t* A, const matrix_t* B,
+                              double* flops, double* bytes);
+
+// max |x - ref| / max |ref|; infinite when the shapes differ.
+double bench_output_difference(const bench_output_t* x, const bench_output_t* ref);
+void bench_output_free(bench_output_t* output);
+
+void benchmark_summarize(double* times, int runs, double flops, double bytes,
+                         bench_stats_t* stats);
+void benchmark_print(const char* title, const bench_result_t* results, int count);
+
+#endif
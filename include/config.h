@@ -1,10 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-#define MAX_MATRICES 200
 #define MAX_PROCESSES 20
 #define MAX_FILENAME 256
-#define MAX_MATRIX_SIZE 100
 #define BUFFER_SIZE 1024
 #define PROCESS_TIMEOUT 300
 #define MENU_ITEMS 18
@@ -23,9 +21,14 @@ typedef struct {
     int performance_test_size;
     int openmp_threads;
     int enable_process_pool;
+    int simd_level;
+    int benchmark_warmup;   // untimed runs before each benchmark
+    int benchmark_runs;     // timed runs per engine in a benchmark
+    int perf_counters;      // read hardware counters around engine calls
     
     // UI Settings
     int show_timings;
+    char trace_file[MAX_FILENAME];  // Chrome trace written at exit, empty = off
     int auto_save_interval;
     int auto_load_on_startup;
     int create_backups;
@@ -33,6 +36,8 @@ typedef struct {
     // Memory Settings
     int enable_memory_check;
     int cache_size;
+    int save_binary;        // save folders as binary .mat instead of text
+    int verify_checksums;   // check .mat payload checksums on load
     
     // Algorithm Settings
     double eigen_tolerance;
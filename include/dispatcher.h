@@ -0,0 +1,65 @@
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+#include "matrix_operations.h"
+
+// Numbered like the menu's method choices and the multiplication_method /
+// determinant_method config keys, where 0 selects the cost model.
+typedef enum {
+    ENGINE_AUTO = 0,
+    ENGINE_SEQUENTIAL = 1,
+    ENGINE_PROCESSES = 2,
+    ENGINE_OPENMP = 3
+} engine_t;
+
+typedef enum {
+    DISPATCH_ADD,
+    DISPATCH_SUBTRACT,
+    DISPATCH_MULTIPLY,
+    DISPATCH_DETERMINANT
+} dispatch_op_t;
+
+// Square GEMM size and element-wise vector length timed at calibration.
+#define DISPATCH_CALIBRATION_GEMM 256
+#define DISPATCH_CALIBRATION_STREAM (1 << 20)
+
+// Machine rates measured by dispatcher_calibrate. Every engine is priced
+// as a fixed overhead plus work divided by the matching rate.
+typedef struct {
+    int calibrated;
+    int threads;            // OpenMP threads available
+    int cores;              // online CPUs; caps the speedup of any engine
+    int workers;            // live pool workers, 0 when the pool is off
+    double gemm_rate;       // flop/s of the single-thread blocked GEMM
+    double omp_gemm_rate;   // flop/s of the threaded GEMM
+    double stream_rate;     // bytes/s of a single-thread element-wise pass
+    double omp_stream_rate; // bytes/s of the threaded element-wise pass
+    double fault_rate;      // bytes/s of first writes to freshly mapped pages
+    double omp_overhead;    // seconds to fork and join one parallel region
+    double omp_barrier;     // seconds per barrier inside a running region
+    double pool_overhead;   // seconds for one small operation through the pool
+} dispatch_model_t;
+
+extern dispatch_model_t dispatch_model;
+
+// Times the kernels behind each engine; takes a few tens of milliseconds.
+// Must run after the process pool is started to price it.
+void dispatcher_calibrate(void);
+void dispatcher_print_model(void);
+
+const char* engine_name(engine_t engine);
+
+// Predicted wall time of op on engine; B is NULL for the determinant.
+double dispatcher_estimate(dispatch_op_t op, engine_t engine,
+                           const matrix_t* A, const matrix_t* B);
+
+// Engine forced by config for op, otherwise the cheapest available one.
+engine_t dispatcher_choose(dispatch_op_t op, const matrix_t* A, const matrix_t* B);
+
+// Run op on engine, resolving ENGINE_AUTO through dispatcher_choose.
+// *used receives the engine that ran.
+matrix_t* dispatch_binary(dispatch_op_t op, engine_t engine,
+                          const matrix_t* A, const matrix_t* B, engine_t* used);
+double dispatch_determinant(engine_t engine, const matrix_t* matrix, engine_t* used);
+
+#endif
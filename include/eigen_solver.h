@@ -0,0 +1,52 @@
+#ifndef EIGEN_SOLVER_H
+#define EIGEN_SOLVER_H
+
+#include "matrix_operations.h"
+
+// Francis QR steps allowed per eigenvalue before giving up (LAPACK uses 30).
+#define EIGEN_QR_STEPS_PER_VALUE 30
+
+// Below this many rows the Householder updates stay on one thread.
+#define EIGEN_PARALLEL_MIN_ROWS 64
+
+// Column chunk width when the left Householder update is split over threads.
+#define EIGEN_HOUSEHOLDER_CHUNK 256
+
+// Relative difference between a(i,j) and a(j,i) still treated as symmetric.
+#define EIGEN_SYMMETRY_TOLERANCE 1e-12
+
+// Implicit QL steps allowed per eigenvalue of the tridiagonal matrix.
+#define EIGEN_QL_STEPS_PER_VALUE 30
+
+// Jacobi sweeps (n-1 rounds of n/2 rotations each) before giving up.
+#define EIGEN_JACOBI_MAX_SWEEPS 50
+
+// Full spectrum of a general square matrix: Householder reduction to upper
+// Hessenberg form, Francis double-shift QR with deflation down to real
+// Schur form, then eigenvectors by back-substitution and back-transformation.
+// Complex pairs come out as adjacent conjugate entries. Results are sorted
+// by descending real part and every eigenvector has unit 2-norm.
+// Returns 0 on success, -1 if QR fails to converge.
+int eigen_solve_general(const matrix_t* matrix, eigen_t** eigenvalues, int* count);
+
+int eigen_matrix_is_symmetric(const matrix_t* matrix);
+
+// Symmetric solvers return all n real eigenvalues with an orthonormal set
+// of eigenvectors, sorted like eigen_solve_general. Only the symmetric part
+// (A + A^T) / 2 of the input is used.
+
+// Householder tridiagonalization followed by implicit QL (EISPACK tred2 +
+// tql2). The usual choice for dense symmetric matrices.
+int eigen_solve_symmetric_ql(const matrix_t* matrix, eigen_t** eigenvalues, int* count);
+
+// Cyclic Jacobi in round-robin order: each round rotates n/2 disjoint
+// (p, q) pairs, which are applied concurrently on OpenMP threads. Runs until
+// the off-diagonal norm drops below eigen_tolerance times the matrix norm.
+int eigen_solve_symmetric_jacobi(const matrix_t* matrix, eigen_t** eigenvalues, int* count);
+
+// Same solvers on a raw n x n row-major array with leading dimension lda:
+// tridiagonal QL when symmetric is set, Hessenberg + QR otherwise.
+int eigen_solve_dense(const double* a, int n, int lda, int symmetric,
+                      eigen_t** eigenvalues, int* count);
+
+#endif
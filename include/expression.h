@@ -0,0 +1,70 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <stddef.h>
+#include "matrix_operations.h"
+
+// Lazy matrix expressions. Building an expression only records a node in
+// a small DAG; expr_evaluate then fuses every chain of element-wise nodes
+// into one pass over the rows, computing a block of each node at a time
+// in per-thread scratch, so no full-size temporaries are created. Matrix
+// products break fusion and are materialized once through the dispatcher.
+//
+// Identical nodes are shared as they are built, so a repeated
+// sub-expression is computed once per block however often it is used.
+
+// Nodes per graph.
+#define EXPR_MAX_NODES 128
+// Columns per fused block; one block of every intermediate stays in L1/L2.
+#define EXPR_BLOCK 512
+// Smallest result (in elements) evaluated with OpenMP.
+#define EXPR_PARALLEL_MIN_ELEMENTS (1 << 15)
+
+typedef enum {
+    EXPR_INPUT,      // a registered or caller-owned matrix
+    EXPR_ADD,
+    EXPR_SUBTRACT,
+    EXPR_HADAMARD,   // element-wise product
+    EXPR_SCALE,      // scalar * a
+    EXPR_MULTIPLY    // matrix product, not fusable
+} expr_op_t;
+
+typedef struct expr_node {
+    expr_op_t op;
+    int rows;
+    int cols;
+    const struct expr_node* a;
+    const struct expr_node* b;
+    double scalar;
+    const matrix_t* input;   // EXPR_INPUT
+    matrix_t* value;         // materialized product, owned by the graph
+} expr_t;
+
+typedef struct {
+    expr_t nodes[EXPR_MAX_NODES];
+    int count;
+} expr_graph_t;
+
+expr_graph_t* expr_graph_create(void);
+// Frees the graph and any products it materialized; inputs are untouched.
+void expr_graph_free(expr_graph_t* graph);
+
+// Builders return NULL on a shape mismatch, a full graph or a NULL
+// operand, so calls can be nested and checked once at the end. Inputs
+// must stay alive and unmodified until evaluation.
+expr_t* expr_input(expr_graph_t* graph, const matrix_t* matrix);
+expr_t* expr_add(expr_graph_t* graph, const expr_t* a, const expr_t* b);
+expr_t* expr_subtract(expr_graph_t* graph, const expr_t* a, const expr_t* b);
+expr_t* expr_hadamard(expr_graph_t* graph, const expr_t* a, const expr_t* b);
+expr_t* expr_scale(expr_graph_t* graph, double scalar, const expr_t* a);
+expr_t* expr_multiply(expr_graph_t* graph, const expr_t* a, const expr_t* b);
+
+// Parses infix text over registry names: + and -, * (element-wise, or
+// scaling when one side is a number), @ (matrix product), unary minus and
+// parentheses. On failure returns NULL with a message in error.
+expr_t* expr_parse(expr_graph_t* graph, const char* text, char* error, size_t error_size);
+
+// Computes root into a new matrix called name, owned by the caller.
+matrix_t* expr_evaluate(expr_graph_t* graph, const expr_t* root, const char* name);
+
+#endif
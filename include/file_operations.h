@@ -1,15 +1,65 @@
 #ifndef FILE_OPERATIONS_H
 #define FILE_OPERATIONS_H
 
+#include <stdint.h>
 #include "matrix_operations.h"
 #define MAX_FILENAME 256
 
+// Files parsed concurrently by read_matrices_from_folder before they are
+// registered; bounds the memory held by not-yet-registered matrices.
+#define FOLDER_LOAD_BATCH 64
+
+// Text reader buffer size, and the longest number it is guaranteed to see
+// in one piece.
+#define TEXT_READ_CHUNK (1 << 20)
+#define TEXT_MAX_TOKEN 512
+// Fewest bytes a text cell takes (a digit and a separator); a "# Matrix:"
+// header declaring more cells than the file can hold is ignored.
+#define TEXT_MIN_CELL_BYTES 2
+
+// Bytes of formatted rows per text writer buffer; one write() each.
+#define TEXT_WRITE_CHUNK (1 << 20)
+
+// Binary .mat files: a fixed header padded to MATRIX_FILE_PAYLOAD_OFFSET,
+// then rows * stride doubles in native byte order, exactly as matrix_t
+// stores them. The payload offset is page aligned so the loader can mmap()
+// it straight into the matrix buffer.
+#define MATRIX_FILE_MAGIC "MATOPSB"
+#define MATRIX_FILE_VERSION 1
+#define MATRIX_FILE_DTYPE_F64 1
+#define MATRIX_FILE_BYTE_ORDER 0x01020304u
+#define MATRIX_FILE_PAYLOAD_OFFSET 4096
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t byte_order;     // MATRIX_FILE_BYTE_ORDER as written by the saver
+    int32_t rows;
+    int32_t cols;
+    int32_t stride;          // doubles per stored row, >= cols
+    uint64_t payload_offset;
+    uint64_t payload_bytes;
+    uint64_t payload_checksum;
+    char name[64];
+    uint64_t header_checksum; // over every byte above
+} matrix_file_header_t;
+
 matrix_t* read_matrix_from_file(const char* filename);
+// Same without progress or error messages; NULL on any failure.
+matrix_t* read_matrix_quiet(const char* filename);
 int write_matrix_to_file(const matrix_t* matrix, const char* filename);
+// Text format with round-trip (usually shortest) numbers; silent, returns 0 or -1.
+int write_matrix_text(const matrix_t* matrix, const char* filename);
+matrix_t* read_matrix_binary(const char* filename);
+int write_matrix_binary(const matrix_t* matrix, const char* filename);
 int read_matrices_from_folder(const char* folder_path);
 int write_matrices_to_folder(const char* folder_path);
 int load_matrix_directory();
 void save_matrix_directory();
-void get_matrix_files(const char* folder_path, char files[][MAX_FILENAME], int* count);
+typedef char matrix_path_t[MAX_FILENAME];
+// .txt and .mat files in folder_path, sorted by name, with a .txt dropped
+// when a .mat of the same name exists. The caller frees the array.
+matrix_path_t* get_matrix_files(const char* folder_path, int* count);
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef FLOAT_FORMAT_H
+#define FLOAT_FORMAT_H
+
+// Longest text format_double can produce, including the terminating NUL
+// ("-1.2345678901234567e-308").
+#define FLOAT_FORMAT_MAX_CHARS 32
+
+// Writes value as a decimal that reads back (strtod) to exactly the same
+// double, using Grisu2. The digits are usually the shortest possible; for
+// about 0.1% of doubles they are slightly longer. Plain notation for
+// magnitudes in [1e-5, 1e17), exponent notation otherwise, "nan" / "inf"
+// for non-finite values. out must hold FLOAT_FORMAT_MAX_CHARS bytes; the
+// result is NUL terminated and its length is returned.
+int format_double(double value, char* out);
+
+#endif
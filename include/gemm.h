@@ -0,0 +1,24 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+// Cache blocking parameters for the packed GEMM engine.
+// KC x NR panels of B and MR x KC panels of A stay in L1,
+// an MC x KC block of A stays in L2 and a KC x NC panel of B in L3.
+// MR x NR is the register tile of the selected SIMD micro-kernel
+// (see simd_kernels.h); MC is rounded down to a multiple of MR.
+#define GEMM_MC 128
+#define GEMM_KC 256
+#define GEMM_NC 4096
+
+// Below this many multiply-adds the packing overhead is not worth it.
+#define GEMM_SMALL_WORK (48 * 48 * 48)
+
+// C += alpha * A * B, where A is m x k, B is k x n and C is m x n,
+// all row-major with leading dimensions lda, ldb and ldc.
+// A non-zero parallel flag splits the macro-tiles across OpenMP threads.
+void gemm_compute(int m, int n, int k, double alpha,
+                  const double* A, int lda,
+                  const double* B, int ldb,
+                  double* C, int ldc, int parallel);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef KRYLOV_EIGEN_H
+#define KRYLOV_EIGEN_H
+
+#include "matrix_operations.h"
+
+// Smallest Krylov basis worth restarting; the basis holds at least 2k + 1
+// vectors and never more than n.
+#define KRYLOV_MIN_BASIS 20
+
+// y = A x for the operator whose eigenpairs are wanted. x and y have n
+// entries and never alias.
+typedef void (*eigen_matvec_fn)(void* context, const double* x, double* y);
+
+// k eigenpairs of largest magnitude of an n x n operator, by implicitly
+// restarted Arnoldi (Lanczos when symmetric is set). The operator is only
+// touched through matvec. Restarts stop once every wanted Ritz pair has a
+// residual below eigen_tolerance relative to its eigenvalue, and give up
+// after eigen_max_iterations restarts (both from global_config).
+// Results are sorted by descending magnitude. Returns 0 on success, -1 if
+// the pairs did not converge.
+int eigen_solve_top_k(int n, eigen_matvec_fn matvec, void* context, int symmetric,
+                      int k, eigen_t** eigenvalues, int* count);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef LU_DECOMPOSITION_H
+#define LU_DECOMPOSITION_H
+
+// Columns per panel of the right-looking blocked LU. Each step factors an
+// n x LU_BLOCK_SIZE panel, solves the LU_BLOCK_SIZE-row block of U to its
+// right and then hands the trailing matrix to a GEMM-style update.
+#define LU_BLOCK_SIZE 64
+
+// Pivot columns shorter than this are searched and eliminated by one thread.
+#define LU_PARALLEL_MIN_ROWS 256
+
+// Column chunk width for the parallel triangular solve of a U row block.
+#define LU_SOLVE_CHUNK 256
+
+// Pivots smaller than this in magnitude make the matrix count as singular.
+#define LU_SINGULAR_TOLERANCE 1e-12
+
+// Trailing update A22 -= L21 * U12, where L21 is m x k, U12 is k x n and
+// A22 is m x n, all inside the matrix being factored with leading
+// dimension lda. Returns 0 on success, -1 if A22 may be left inconsistent.
+typedef int (*lu_update_fn)(void* context, int m, int n, int k,
+                            const double* L21, const double* U12, double* A22, int lda);
+
+// Factors the n x n row-major matrix a in place with partial pivoting and
+// stores its determinant in *det. The panel and the triangular solve run on
+// OpenMP threads when parallel is set. A NULL update uses gemm_compute.
+// Returns 0 on success and -1 when the trailing update failed.
+int lu_determinant_blocked(double* a, int n, int lda, int parallel,
+                           lu_update_fn update, void* context, double* det);
+
+#endif
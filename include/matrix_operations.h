@@ -1,21 +1,34 @@
 #ifndef MATRIX_OPERATIONS_H
 #define MATRIX_OPERATIONS_H
 
+#include <stddef.h>
 #include <time.h>
 
-#define MAX_MATRICES 200
-#define MAX_MATRIX_SIZE 100
+// Sanity bound on either dimension; the practical limit is memory.
+#define MATRIX_MAX_DIMENSION 1000000
+// Registry slots and hash buckets allocated up front; both double as needed.
+#define MATRIX_REGISTRY_INITIAL_CAPACITY 64
+// display_matrix shows only this many leading and trailing rows and columns
+// of larger matrices.
+#define MATRIX_DISPLAY_EDGE 6
 #define EIGEN_MAX_ITER 1000
 #define EIGEN_TOLERANCE 1e-10
+#define MATRIX_ALIGNMENT 64
 
 typedef struct {
     int rows;
     int cols;
     char name[50];
     int id;
-    double** data;
+    double** data;      // row views into storage, kept for compatibility
+    double* storage;    // single MATRIX_ALIGNMENT-aligned buffer
+    int stride;         // leading dimension: doubles between consecutive rows
+    size_t mapped_length; // non-zero when storage is an mmap()ed region of this size
+    unsigned long version; // changes whenever the contents are edited in place
 } matrix_t;
 
+#define MATRIX_ROW(m, i) ((m)->storage + (size_t)(i) * (size_t)(m)->stride)
+
 typedef struct {
     double start_time;
     double end_time;
@@ -24,15 +37,23 @@ typedef struct {
 typedef struct {
     double eigenvalue;
     double* eigenvector;
+    double eigenvalue_imag;    // non-zero for one half of a complex conjugate pair
+    double* eigenvector_imag;  // imaginary part of eigenvector, NULL for real eigenvalues
 } eigen_t;
 
 extern int use_openmp_flag;
-extern matrix_t* matrix_registry[MAX_MATRICES];
+// Registry slots 0..matrix_registry_capacity-1; empty slots are NULL.
+extern matrix_t** matrix_registry;
+extern int matrix_registry_capacity;
 extern int matrix_count;
 extern int next_matrix_id;
 double matrix_determinant_openmp(const matrix_t* matrix);
 matrix_t* create_matrix(int rows, int cols, const char* name);
+matrix_t* create_matrix_on_mapping(int rows, int cols, const char* name,
+                                   double* storage, int stride, size_t mapped_length);
+int matrix_stride_for(int cols);
 void free_matrix(matrix_t* matrix);
+void matrix_mark_modified(matrix_t* matrix);
 matrix_t* copy_matrix(const matrix_t* original);
 matrix_t* create_random_matrix(int rows, int cols, const char* name);
 
@@ -48,7 +69,14 @@ double matrix_determinant_seq(const matrix_t* matrix);
 double matrix_determinant_lu(const matrix_t* matrix);
 
 int find_eigenvalues_eigenvectors(const matrix_t* matrix, eigen_t** eigenvalues, int* count);
+// The automatic routing shared by the menu, scripts and the server: the
+// top k by the restarted Krylov solver when k > 0, otherwise the full
+// spectrum by tridiagonal QL for symmetric input and Francis QR for the
+// rest. Prints nothing; solver, if not NULL, receives the method's name.
+int find_eigenvalues_auto(const matrix_t* matrix, int k, eigen_t** eigenvalues, int* count,
+                          const char** solver);
 int find_eigenvalues_qr(const matrix_t* matrix, eigen_t** eigenvalues, int* count);
+int find_top_eigenvalues(const matrix_t* matrix, int k, eigen_t** eigenvalues, int* count);
 int find_dominant_eigenvalue(const matrix_t* matrix, double* eigenvalue, double* eigenvector);
 void free_eigen_results(eigen_t* eigenvalues, int count);
 void display_eigen_results(const eigen_t* eigenvalues, int count, int matrix_size);
@@ -61,13 +89,17 @@ void vector_normalize(double* v, int n);
 
 int add_matrix_to_registry(matrix_t* matrix);
 void remove_matrix_from_registry(int matrix_id);
+// Unregisters and frees a matrix without a console message; -1 if unknown.
+int release_matrix(int matrix_id);
 matrix_t* find_matrix_by_id(int matrix_id);
+matrix_t* find_matrix_by_name(const char* name);
 void display_matrix(const matrix_t* matrix);
 void display_all_matrices();
 void clear_matrix_registry();
 void debug_file_content(const char* filename);
 
 int is_openmp_enabled(void);
+double monotonic_seconds(void);
 void start_timer(performance_timer_t* timer);
 void stop_timer(performance_timer_t* timer);
 double get_elapsed_time(const performance_timer_t* timer);
@@ -22,6 +22,7 @@ void list_files_in_directory(const char* path);
 void delete_matrix_from_folder_helper(matrix_t* matrix, const char* folder_path, const char* folder_type);
 
 int get_user_choice(const char* prompt, int min, int max);
+int get_matrix_choice(const char* prompt);
 void clear_input_buffer();
 void press_enter_to_continue();
 
@@ -0,0 +1,75 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <sys/types.h>
+#include "dispatcher.h"
+
+// Events read through perf_event_open. Hardware events the CPU or the
+// hypervisor does not expose are dropped at startup; page faults are a
+// software event and are normally always available.
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_STALLED_FRONTEND,
+    PERF_STALLED_BACKEND,
+    PERF_PAGE_FAULTS,
+    PERF_EVENT_COUNT
+} perf_event_id_t;
+
+// Tasks counted at once: the main thread, OpenMP threads and pool workers.
+#define PERF_MAX_TASKS 256
+
+// Counts of one measured interval summed over every counted task. Values
+// are scaled by enabled/running time when the kernel multiplexed events.
+typedef struct {
+    int active;                      // set by perf_begin for the outermost call
+    unsigned valid;                  // bit e set when event e was counted
+    double values[PERF_EVENT_COUNT];
+} perf_sample_t;
+
+// Calls and summed counts of every engine run through the dispatcher.
+typedef struct {
+    unsigned long calls;
+    perf_sample_t total;
+} perf_engine_stats_t;
+
+// Opens the counters on the calling thread and every live pool worker;
+// OpenMP threads are attached on first use. Does nothing when the
+// perf_counters config key is 0. Returns the mask of usable events.
+unsigned perf_counters_init(void);
+// Counts a pool worker started after init, e.g. one respawned after a
+// crash; called by the pool in the parent. No-op when counters are off.
+void perf_attach_worker(pid_t pid);
+void perf_counters_shutdown(void);
+unsigned perf_counters_available(void);
+// "Hardware counters: ..." line naming the usable events.
+void perf_print_available(void);
+
+// Brackets a measured interval. Nested pairs are no-ops so that an outer
+// measurement (a benchmark batch) is not disturbed by inner ones (engine
+// calls). After perf_end an active sample holds the counts of the interval.
+void perf_begin(perf_sample_t* sample);
+void perf_end(perf_sample_t* sample);
+
+// Adds an engine call to that engine's totals.
+void perf_record_engine(engine_t engine, const perf_sample_t* sample);
+// Counts of the last completed outermost interval; inactive if none.
+const perf_sample_t* perf_last_sample(void);
+const perf_engine_stats_t* perf_engine_stats(engine_t engine);
+
+// Divides every count by n, turning a batch total into a per-run average.
+void perf_sample_scale(perf_sample_t* sample, double n);
+
+const char* perf_event_name(perf_event_id_t event);
+double perf_sample_ipc(const perf_sample_t* sample);
+
+// One "Counters: ..." line for an active sample, nothing otherwise.
+void perf_print_sample(const perf_sample_t* sample);
+// Table rows: a header naming the first column, then one row per sample.
+void perf_print_header(const char* label);
+void perf_print_row(const char* label, const perf_sample_t* sample);
+void perf_print_engine_stats(void);
+
+#endif
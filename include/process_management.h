@@ -7,13 +7,40 @@
 #include "config.h"
 #include "matrix_operations.h"
 
+// Tiles handed out per pool worker; extra tiles smooth out load imbalance.
+#define POOL_TILES_PER_WORKER 2
+
 typedef enum {
-    OP_ADD_ELEMENT,
-    OP_SUBTRACT_ELEMENT, 
-    OP_MULTIPLY_ELEMENT,
-    OP_DETERMINANT_PART
+    OP_ADD_TILE,
+    OP_SUBTRACT_TILE,
+    OP_MULTIPLY_TILE,
+    OP_LU_UPDATE_TILE,
+    OP_RELEASE_ARENA
 } operation_type_t;
 
+// Control message written to a worker's pipe_in. Operands and the result
+// live in the shared-memory arena arena_id of the parent; offsets and
+// leading dimensions are counted in doubles from the arena base.
+// Add/subtract: C = A +/- B over m x n. Multiply: C = alpha * A * B with
+// A m x k and B k x n. LU update: C += alpha * A * B, accumulated into the
+// trailing matrix. The worker writes C in place and answers with one
+// int status. OP_RELEASE_ARENA unmaps the arena and gets no answer.
+typedef struct {
+    operation_type_t op;
+    unsigned arena_id;
+    size_t arena_size;
+    size_t a_offset;
+    size_t b_offset;
+    size_t c_offset;
+    int lda;
+    int ldb;
+    int ldc;
+    int m;
+    int n;
+    int k;
+    double alpha;
+} tile_job_t;
+
 typedef struct {
     pid_t pid;
     int pipe_in[2];
@@ -25,6 +52,8 @@ typedef struct {
 
 extern child_process_t process_pool[MAX_PROCESSES];
 extern int active_processes;
+// Report worker counts after each pooled operation; benchmarks turn it off.
+extern int pool_verbose;
 
 void setup_signal_handlers();
 void computation_start_handler(int sig);
@@ -45,5 +74,6 @@ matrix_t* add_matrices_parallel(const matrix_t* A, const matrix_t* B);
 matrix_t* subtract_matrices_parallel(const matrix_t* A, const matrix_t* B);
 matrix_t* multiply_matrices_parallel(const matrix_t* A, const matrix_t* B);
 double matrix_determinant_parallel(const matrix_t* matrix);
+int pool_probe(void);
 
 #endif
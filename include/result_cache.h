@@ -0,0 +1,72 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "matrix_operations.h"
+
+// Results larger than this are never cached, and older entries are evicted
+// until the cached payloads fit. The entry limit is config cache_size.
+#define RESULT_CACHE_MAX_BYTES ((size_t)256 << 20)
+
+typedef enum {
+    CACHE_OP_ADD,
+    CACHE_OP_SUBTRACT,
+    CACHE_OP_MULTIPLY,
+    CACHE_OP_DETERMINANT,
+    CACHE_OP_EIGEN
+} cache_op_t;
+
+// Eigen result variants, one per solver routing, so callers that share an
+// entry always share the solver behind it. param is k for CACHE_EIGEN_TOP_K.
+typedef enum {
+    CACHE_EIGEN_QR = 1,      // full spectrum, Francis QR
+    CACHE_EIGEN_AUTO,        // find_eigenvalues_auto with k = 0
+    CACHE_EIGEN_DOMINANT,    // power method
+    CACHE_EIGEN_JACOBI,      // cyclic Jacobi, QR for non-symmetric input
+    CACHE_EIGEN_TOP_K        // find_eigenvalues_auto with k > 0
+} cache_eigen_variant_t;
+
+// Operands are identified by registry ID plus content version, so an edit
+// or a reloaded matrix that reuses an ID never matches an old entry.
+// variant and param tell apart results of the same operation that differ
+// (the eigen method and its k); they are 0 when the result is unique.
+typedef struct {
+    cache_op_t op;
+    int variant;
+    int param;
+    int a_id;
+    unsigned long a_version;
+    int b_id;
+    unsigned long b_version;
+} cache_key_t;
+
+typedef struct {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long invalidations;
+    int entries;
+    size_t bytes;
+} result_cache_stats_t;
+
+// B may be NULL for single-operand operations.
+cache_key_t result_cache_key(cache_op_t op, int variant, int param,
+                             const matrix_t* A, const matrix_t* B);
+
+// Lookups return 0 on a hit and -1 on a miss. Matrix and eigen results are
+// handed out as fresh copies owned by the caller; puts store copies too, so
+// the caller keeps ownership of what it passes in.
+int result_cache_get_determinant(const cache_key_t* key, double* det);
+void result_cache_put_determinant(const cache_key_t* key, double det);
+matrix_t* result_cache_get_matrix(const cache_key_t* key);
+void result_cache_put_matrix(const cache_key_t* key, const matrix_t* result);
+int result_cache_get_eigen(const cache_key_t* key, eigen_t** eigenvalues, int* count);
+void result_cache_put_eigen(const cache_key_t* key, const eigen_t* eigenvalues,
+                            int count, int n);
+
+// Drops every entry that has matrix_id as an operand.
+void result_cache_invalidate(int matrix_id);
+void result_cache_clear(void);
+void result_cache_get_stats(result_cache_stats_t* stats);
+void result_cache_print_stats(void);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SCRIPT_RUNNER_H
+#define SCRIPT_RUNNER_H
+
+#include <stdio.h>
+
+// Headless batch mode (matrix_ops --script FILE, "-" for stdin). One
+// command per line, either as words or as a JSON object:
+//
+//   load NAME PATH           {"op":"load","name":"A","path":"a.mat"}
+//   random NAME ROWS COLS    {"op":"random","name":"A","rows":512,"cols":512}
+//   add|sub|mul OUT A B      {"op":"mul","out":"C","a":"A","b":"B"}
+//   transpose OUT A          {"op":"transpose","out":"T","a":"A"}
+//   eval OUT EXPR            {"op":"eval","out":"D","expr":"(A + B) - 2 * C"}
+//   det A                    {"op":"det","a":"A"}
+//   eig A [K]                {"op":"eig","a":"A","k":3}
+//   save A PATH              {"op":"save","a":"C","path":"c.mat"}
+//   free A                   {"op":"free","a":"C"}
+//   engine auto|sequential|processes|openmp
+//
+// Matrices are registry entries looked up by name; an output replaces any
+// matrix of the same name. eval uses the expr_parse syntax (expression.h).
+// Blank lines and lines starting with # are skipped. Determinants and
+// eigenvalues are written to results, one line per command; with
+// show_timings set, each command's time goes to stderr.
+
+#define SCRIPT_MAX_LINE 4096
+
+// Runs every command of input, carrying on after a failed one.
+// Returns the number of commands that failed.
+int script_run(FILE* input, const char* source, FILE* results);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+
+// Compute server (matrix_ops --serve SOCKET). The process keeps the
+// registry, process pool, calibration and result cache warm and serves
+// requests over a SOCK_SEQPACKET UNIX socket, one server_request_t per
+// message answered by one server_response_t. Clients are multiplexed with
+// epoll; requests are executed one at a time in arrival order.
+//
+// Matrix payloads never go through the socket. They are passed as file
+// descriptors (SCM_RIGHTS), normally memfds, holding rows x stride
+// doubles in row-major order:
+//   PUT    request carries the payload fd and returns the new ID. A memfd
+//          sealed with F_SEAL_SHRINK | F_SEAL_WRITE (created with
+//          MFD_ALLOW_SEALING) is mapped privately without copying; any
+//          other fd is copied, as it could change or shrink later.
+//   GET    response carries a memfd with the matrix a (stride in response).
+//   EIGEN  response carries a memfd of count (real, imaginary) pairs.
+// Memfds sent by the server are sealed against every change.
+// Results are registered matrices and stay until FREE; clients own them.
+
+#define SERVER_MAGIC 0x3153584dU   // "MXS1"
+#define SERVER_MAX_CLIENTS 256
+#define SERVER_NAME_SIZE 48
+
+typedef enum {
+    SERVER_OP_PING = 0,
+    SERVER_OP_FIND,         // name -> id, e.g. matrices auto-loaded at startup
+    SERVER_OP_PUT,          // rows, cols, stride, name + payload fd -> id
+    SERVER_OP_GET,          // a -> payload fd
+    SERVER_OP_ADD,          // a, b, engine -> id
+    SERVER_OP_SUBTRACT,
+    SERVER_OP_MULTIPLY,
+    SERVER_OP_TRANSPOSE,    // a -> id
+    SERVER_OP_DETERMINANT,  // a, engine -> value
+    SERVER_OP_EIGEN,        // a, k (0 = full spectrum) -> count + payload fd
+    SERVER_OP_FREE,         // a
+    SERVER_OP_SHUTDOWN
+} server_op_t;
+
+typedef enum {
+    SERVER_OK = 0,
+    SERVER_E_PROTOCOL = -1,   // bad size, magic or op
+    SERVER_E_NOT_FOUND = -2,  // unknown matrix ID or name
+    SERVER_E_ARGUMENT = -3,   // shapes, k or payload do not fit the op
+    SERVER_E_FAILED = -4      // the computation itself failed
+} server_status_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t op;
+    int32_t engine;    // engine_t; ENGINE_AUTO (0) lets the dispatcher choose
+    int32_t a;
+    int32_t b;
+    int32_t k;
+    int32_t rows;
+    int32_t cols;
+    int32_t stride;    // PUT: doubles between rows in the payload, >= cols
+    char name[SERVER_NAME_SIZE];  // FIND key; optional name for new matrices
+} server_request_t;
+
+typedef struct {
+    uint32_t magic;
+    int32_t status;    // server_status_t
+    int32_t id;        // new or found matrix
+    int32_t rows;
+    int32_t cols;
+    int32_t stride;
+    int32_t count;     // eigenvalues in the payload
+    int32_t engine;    // engine that ran, -1 for a cached result
+    double value;      // determinant
+    double seconds;    // time spent serving the request
+} server_response_t;
+
+// Serves until a SHUTDOWN request, SIGINT or SIGTERM. The socket file is
+// created at path (replacing a stale socket) and removed on return.
+// Returns 0 on a clean shutdown, -1 if the socket cannot be set up.
+int server_run(const char* path);
+
+#endif
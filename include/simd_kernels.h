@@ -0,0 +1,36 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#define SIMD_MAX_MR 8
+#define SIMD_MAX_NR 16
+
+typedef enum {
+    SIMD_AUTO = 0,
+    SIMD_SCALAR = 1,
+    SIMD_AVX2 = 2,
+    SIMD_AVX512 = 3
+} simd_level_t;
+
+typedef struct {
+    simd_level_t level;
+    const char* name;
+    int gemm_mr;
+    int gemm_nr;
+    // C[0:mr, 0:nr] += Ap * Bp over kc packed steps (gemm_mr x gemm_nr tile)
+    void (*gemm_micro_kernel)(int kc, const double* Ap, const double* Bp,
+                              double* C, int ldc, int mr, int nr);
+    void (*vector_add)(const double* a, const double* b, double* c, int n);
+    void (*vector_sub)(const double* a, const double* b, double* c, int n);
+    double (*vector_dot)(const double* a, const double* b, int n);
+    // y += alpha * x, the row update of the LU rank-1 step
+    void (*vector_axpy)(double alpha, const double* x, double* y, int n);
+} simd_kernels_t;
+
+// Starts out as the scalar set so kernels work before simd_initialize().
+extern simd_kernels_t simd_kernels;
+
+simd_level_t simd_detect_level(void);
+int simd_initialize(simd_level_t requested);
+const char* simd_level_name(simd_level_t level);
+
+#endif
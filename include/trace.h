@@ -0,0 +1,35 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Span tracing exported as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Every thread and pool worker records complete spans
+// into its own ring buffer; the rings live in one shared mapping so the
+// parent can export the workers' spans as well, each worker as its own
+// process track.
+
+// Spans kept per thread or worker; older ones are overwritten.
+#define TRACE_RING_EVENTS (1 << 15)
+// Threads and worker processes that can own a ring.
+#define TRACE_MAX_RINGS 64
+
+// Nonzero between trace_init and trace_flush.
+extern int trace_active;
+
+// Maps the rings. Must run before the process pool forks so workers
+// inherit them. Does nothing for an empty path or when a trace was already
+// taken in this run. Returns 0 on success.
+int trace_init(const char* path);
+
+// Called in a freshly forked worker so it takes a ring of its own.
+void trace_fork_child(const char* label);
+
+// Start time of a span, 0 when tracing is off. Pass it to trace_end with
+// a string literal naming the span.
+long long trace_begin(void);
+void trace_end(const char* name, long long start);
+
+// Writes every ring to the path given to trace_init and stops tracing.
+// Returns the number of spans written, or -1 on error.
+int trace_flush(void);
+
+#endif
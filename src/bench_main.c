@@ -0,0 +1,586 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/config.h"
+#include "../include/matrix_operations.h"
+#include "../include/process_management.h"
+#include "../include/openmp_utils.h"
+#include "../include/simd_kernels.h"
+#include "../include/eigen_solver.h"
+#include "../include/dispatcher.h"
+#include "../include/benchmark.h"
+#include "../include/perf_counters.h"
+#include "../include/trace.h"
+
+// Non-interactive benchmark suite (make bench). Sweeps sizes, operations,
+// engines and OpenMP thread counts, writes the results as CSV and JSON and
+// optionally compares them with a baseline CSV from an earlier run.
+
+int use_openmp_flag = 1;
+
+#define BENCH_MAX_LIST 32
+#define BENCH_DEFAULT_SIZES "64,128,256,512,1024"
+#define BENCH_DEFAULT_OPS "add,multiply,determinant,transpose,eigen"
+// The dense eigen solvers are O(n^3) with a large constant; larger sizes
+// are skipped unless --eigen-max raises the limit.
+#define BENCH_DEFAULT_EIGEN_MAX 512
+#define BENCH_DEFAULT_THRESHOLD 0.10
+// Medians below this are dominated by timer and scheduling noise and are
+// not compared against the baseline.
+#define BENCH_MIN_COMPARABLE_SECONDS 1e-5
+
+typedef enum {
+    BENCH_OP_ADD,
+    BENCH_OP_MULTIPLY,
+    BENCH_OP_DETERMINANT,
+    BENCH_OP_TRANSPOSE,
+    BENCH_OP_EIGEN,
+    BENCH_OP_COUNT
+} bench_op_t;
+
+static const char* op_names[BENCH_OP_COUNT] = {
+    "add", "multiply", "determinant", "transpose", "eigen"
+};
+
+// Machine-friendly engine labels used in the CSV and JSON.
+static const char* engine_label(engine_t engine) {
+    switch (engine) {
+        case ENGINE_SEQUENTIAL: return "sequential";
+        case ENGINE_PROCESSES: return "processes";
+        case ENGINE_OPENMP: return "openmp";
+        default: return "auto";
+    }
+}
+
+typedef struct {
+    bench_op_t op;
+    int size;
+    engine_t engine;
+    int threads;
+    bench_stats_t stats;
+    double error;
+    int verified;
+} bench_record_t;
+
+typedef struct {
+    bench_record_t* items;
+    int count;
+    int capacity;
+} record_list_t;
+
+static int record_push(record_list_t* list, const bench_record_t* record) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        bench_record_t* items = (bench_record_t*)realloc(list->items, (size_t)capacity * sizeof(bench_record_t));
+        if (!items) return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = *record;
+    return 0;
+}
+
+typedef struct {
+    int sizes[BENCH_MAX_LIST];
+    int size_count;
+    int ops[BENCH_OP_COUNT];
+    int threads[BENCH_MAX_LIST];
+    int thread_count;
+    int warmup;
+    int runs;
+    int eigen_max;
+    double threshold;
+    const char* csv_path;
+    const char* json_path;
+    const char* baseline_path;
+    const char* config_path;
+    const char* trace_path;
+} bench_options_t;
+
+// Parses a comma-separated list of positive integers.
+static int parse_int_list(const char* text, int* values, int max_values) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < max_values) {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || value > MATRIX_MAX_DIMENSION) return -1;
+        values[count++] = (int)value;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return count;
+}
+
+static int parse_op_list(const char* text, int* ops) {
+    char buffer[256];
+    strncpy(buffer, text, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    memset(ops, 0, BENCH_OP_COUNT * sizeof(int));
+    for (char* token = strtok(buffer, ","); token; token = strtok(NULL, ",")) {
+        int found = 0;
+        for (int op = 0; op < BENCH_OP_COUNT; op++) {
+            if (strcmp(token, op_names[op]) == 0) {
+                ops[op] = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown operation '%s'\n", token);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 1, 2, 4, ... up to the online CPU count, plus that count itself.
+static int default_thread_counts(int* threads) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) cores = 1;
+    int count = 0;
+    for (int t = 1; t < cores && count < BENCH_MAX_LIST - 1; t *= 2) {
+        threads[count++] = t;
+    }
+    threads[count++] = (int)cores;
+    return count;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --sizes LIST       square sizes to sweep (default %s)\n", BENCH_DEFAULT_SIZES);
+    printf("  --ops LIST         operations among %s\n", BENCH_DEFAULT_OPS);
+    printf("  --threads LIST     OpenMP thread counts (default 1,2,4,... up to the cores)\n");
+    printf("  --runs N           timed runs per case (default benchmark_runs)\n");
+    printf("  --warmup N         untimed runs per case (default benchmark_warmup)\n");
+    printf("  --eigen-max N      largest size for eigen (default %d)\n", BENCH_DEFAULT_EIGEN_MAX);
+    printf("  --csv PATH         write results as CSV\n");
+    printf("  --json PATH        write results as JSON\n");
+    printf("  --baseline PATH    compare medians with an earlier CSV\n");
+    printf("  --threshold FRAC   slowdown flagged as a regression (default %.2f)\n", BENCH_DEFAULT_THRESHOLD);
+    printf("  --config PATH      configuration file (default config/config.txt)\n");
+    printf("  --trace PATH       write a Chrome trace of the run (default trace_file)\n");
+    printf("Exit status: 0 ok, 1 bad usage or a result mismatch, 2 regressions found.\n");
+}
+
+static int parse_options(int argc, char* argv[], bench_options_t* options) {
+    const char* sizes = BENCH_DEFAULT_SIZES;
+    const char* ops = BENCH_DEFAULT_OPS;
+    const char* threads = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(argv[0]);
+            exit(0);
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return -1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--sizes") == 0) sizes = value;
+        else if (strcmp(arg, "--ops") == 0) ops = value;
+        else if (strcmp(arg, "--threads") == 0) threads = value;
+        else if (strcmp(arg, "--runs") == 0) options->runs = atoi(value);
+        else if (strcmp(arg, "--warmup") == 0) options->warmup = atoi(value);
+        else if (strcmp(arg, "--eigen-max") == 0) options->eigen_max = atoi(value);
+        else if (strcmp(arg, "--csv") == 0) options->csv_path = value;
+        else if (strcmp(arg, "--json") == 0) options->json_path = value;
+        else if (strcmp(arg, "--baseline") == 0) options->baseline_path = value;
+        else if (strcmp(arg, "--threshold") == 0) options->threshold = atof(value);
+        else if (strcmp(arg, "--config") == 0) options->config_path = value;
+        else if (strcmp(arg, "--trace") == 0) options->trace_path = value;
+        else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return -1;
+        }
+    }
+
+    options->size_count = parse_int_list(sizes, options->sizes, BENCH_MAX_LIST);
+    if (options->size_count <= 0) {
+        fprintf(stderr, "Invalid size list '%s'\n", sizes);
+        return -1;
+    }
+    if (parse_op_list(ops, options->ops) != 0) return -1;
+    if (threads) {
+        options->thread_count = parse_int_list(threads, options->threads, BENCH_MAX_LIST);
+        if (options->thread_count <= 0) {
+            fprintf(stderr, "Invalid thread list '%s'\n", threads);
+            return -1;
+        }
+    } else {
+        options->thread_count = default_thread_counts(options->threads);
+    }
+    return 0;
+}
+
+typedef struct {
+    bench_op_t op;
+    engine_t engine;
+    const matrix_t* A;
+    const matrix_t* B;
+} suite_run_t;
+
+// Real parts then imaginary parts of the spectrum, in solver order.
+static int eigen_output(eigen_t* eigenvalues, int count, bench_output_t* output) {
+    output->values = (double*)malloc(2 * (size_t)count * sizeof(double));
+    if (!output->values) {
+        free_eigen_results(eigenvalues, count);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        output->values[i] = eigenvalues[i].eigenvalue;
+        output->values[count + i] = eigenvalues[i].eigenvalue_imag;
+    }
+    output->count = 2 * count;
+    free_eigen_results(eigenvalues, count);
+    return 0;
+}
+
+static int run_suite_case(void* context, bench_output_t* output) {
+    const suite_run_t* job = (const suite_run_t*)context;
+    switch (job->op) {
+        case BENCH_OP_ADD:
+            output->matrix = dispatch_binary(DISPATCH_ADD, job->engine, job->A, job->B, NULL);
+            return output->matrix ? 0 : -1;
+        case BENCH_OP_MULTIPLY:
+            output->matrix = dispatch_binary(DISPATCH_MULTIPLY, job->engine, job->A, job->B, NULL);
+            return output->matrix ? 0 : -1;
+        case BENCH_OP_DETERMINANT:
+            output->values = (double*)malloc(sizeof(double));
+            if (!output->values) return -1;
+            output->values[0] = dispatch_determinant(job->engine, job->A, NULL);
+            output->count = 1;
+            return 0;
+        case BENCH_OP_TRANSPOSE:
+            output->matrix = matrix_transpose(job->A);
+            return output->matrix ? 0 : -1;
+        case BENCH_OP_EIGEN: {
+            eigen_t* eigenvalues = NULL;
+            int count = 0;
+            if (eigen_solve_symmetric_ql(job->A, &eigenvalues, &count) != 0) return -1;
+            return eigen_output(eigenvalues, count, output);
+        }
+        default:
+            return -1;
+    }
+}
+
+static void operation_size(bench_op_t op, const matrix_t* A, const matrix_t* B,
+                           double* flops, double* bytes) {
+    double n = A->rows;
+    switch (op) {
+        case BENCH_OP_ADD:
+            benchmark_operation_size(DISPATCH_ADD, A, B, flops, bytes);
+            break;
+        case BENCH_OP_MULTIPLY:
+            benchmark_operation_size(DISPATCH_MULTIPLY, A, B, flops, bytes);
+            break;
+        case BENCH_OP_DETERMINANT:
+            benchmark_operation_size(DISPATCH_DETERMINANT, A, B, flops, bytes);
+            break;
+        case BENCH_OP_TRANSPOSE:
+            *flops = 0.0;
+            *bytes = 2.0 * n * n * sizeof(double);
+            break;
+        default:
+            // Nominal count for tridiagonal reduction with accumulated
+            // transforms plus implicit QL with eigenvectors.
+            *flops = 17.0 / 3.0 * n * n * n;
+            *bytes = 2.0 * n * n * sizeof(double);
+            break;
+    }
+}
+
+// Puts the process in the state an engine expects: OpenMP on with the
+// given thread count, or off.
+static void select_engine(engine_t engine, int threads) {
+    if (engine == ENGINE_OPENMP) {
+        enable_openmp();
+        set_openmp_threads(threads);
+    } else {
+        disable_openmp();
+    }
+}
+
+// Runs every engine of one (operation, size) case; the first sequential
+// output is the reference the others are checked against.
+static void run_case(const bench_options_t* options, bench_op_t op, int size,
+                     const matrix_t* A, const matrix_t* B, record_list_t* records, int* mismatches) {
+    engine_t engines[2 + BENCH_MAX_LIST];
+    int threads[2 + BENCH_MAX_LIST];
+    int count = 0;
+    engines[count] = ENGINE_SEQUENTIAL;
+    threads[count++] = 1;
+    int pooled = op == BENCH_OP_ADD || op == BENCH_OP_MULTIPLY || op == BENCH_OP_DETERMINANT;
+    if (pooled && active_processes > 0) {
+        engines[count] = ENGINE_PROCESSES;
+        threads[count++] = active_processes;
+    }
+    if (op != BENCH_OP_TRANSPOSE) {
+        for (int t = 0; t < options->thread_count; t++) {
+            engines[count] = ENGINE_OPENMP;
+            threads[count++] = options->threads[t];
+        }
+    }
+
+    double flops, bytes;
+    operation_size(op, A, B, &flops, &bytes);
+
+    // Results are checked against the sequential engine; when that fails
+    // there is nothing to check against and the others are unchecked.
+    bench_output_t reference;
+    memset(&reference, 0, sizeof(reference));
+    int have_reference = 0;
+    for (int e = 0; e < count; e++) {
+        bench_record_t record;
+        memset(&record, 0, sizeof(record));
+        record.op = op;
+        record.size = size;
+        record.engine = engines[e];
+        record.threads = threads[e];
+
+        select_engine(engines[e], threads[e]);
+        suite_run_t job = { op, engines[e], A, B };
+        bench_output_t output;
+        int completed = benchmark_repeat(run_suite_case, &job, options->warmup, options->runs,
+                                         flops, bytes, &record.stats, &output);
+        if (completed < options->runs) {
+            printf("%-12s %6d %-11s %3d  FAILED (%d of %d runs completed)\n", op_names[op], size,
+                   engine_label(engines[e]), threads[e], completed, options->runs);
+            bench_output_free(&output);
+            (*mismatches)++;
+            continue;
+        }
+
+        const char* verdict;
+        if (e == 0) {
+            reference = output;
+            have_reference = 1;
+            record.verified = 1;
+            verdict = "ok";
+        } else if (!have_reference) {
+            bench_output_free(&output);
+            record.verified = 0;
+            verdict = "UNCHECKED";
+        } else {
+            record.error = bench_output_difference(&output, &reference);
+            record.verified = record.error <= BENCH_VERIFY_TOLERANCE;
+            bench_output_free(&output);
+            verdict = record.verified ? "ok" : "MISMATCH";
+            if (!record.verified) (*mismatches)++;
+        }
+
+        printf("%-12s %6d %-11s %3d  median %.6f s  p90 %.6f s  %8.3f GFLOP/s %8.3f GB/s  %s\n",
+               op_names[op], size, engine_label(engines[e]), threads[e],
+               record.stats.median, record.stats.p90, record.stats.gflops, record.stats.gbps, verdict);
+        if (record.stats.counters.active) {
+            printf("    ");
+            perf_print_sample(&record.stats.counters);
+        }
+        fflush(stdout);
+        record_push(records, &record);
+    }
+    bench_output_free(&reference);
+}
+
+static int write_csv(const char* path, const record_list_t* records) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+    // Counter columns hold per-run averages and are left empty when the
+    // event could not be counted.
+    fprintf(file, "op,size,engine,threads,runs,median_s,p10_s,p90_s,min_s,max_s,mean_s,gflops,gbps,error,verified");
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        fprintf(file, ",%s", perf_event_name((perf_event_id_t)e));
+    }
+    fprintf(file, ",ipc\n");
+    for (int i = 0; i < records->count; i++) {
+        const bench_record_t* r = &records->items[i];
+        const perf_sample_t* counters = &r->stats.counters;
+        fprintf(file, "%s,%d,%s,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.4f,%.4f,%.3e,%d",
+                op_names[r->op], r->size, engine_label(r->engine), r->threads, r->stats.runs,
+                r->stats.median, r->stats.p10, r->stats.p90, r->stats.min, r->stats.max, r->stats.mean,
+                r->stats.gflops, r->stats.gbps, r->error, r->verified);
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            if (counters->active && (counters->valid & (1u << e))) fprintf(file, ",%.0f", counters->values[e]);
+            else fprintf(file, ",");
+        }
+        if (perf_sample_ipc(counters) > 0.0) fprintf(file, ",%.4f\n", perf_sample_ipc(counters));
+        else fprintf(file, ",\n");
+    }
+    fclose(file);
+    return 0;
+}
+
+static int write_json(const char* path, const record_list_t* records, const bench_options_t* options) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+    char host[128] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    char stamp[32];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(file, "{\n  \"host\": {\"name\": \"%s\", \"cores\": %ld, \"simd\": \"%s\", \"pool_workers\": %d},\n",
+            host, sysconf(_SC_NPROCESSORS_ONLN), simd_kernels.name, active_processes);
+    fprintf(file, "  \"timestamp\": \"%s\",\n  \"warmup\": %d,\n  \"runs\": %d,\n  \"results\": [\n",
+            stamp, options->warmup, options->runs);
+    for (int i = 0; i < records->count; i++) {
+        const bench_record_t* r = &records->items[i];
+        fprintf(file, "    {\"op\": \"%s\", \"size\": %d, \"engine\": \"%s\", \"threads\": %d, \"runs\": %d, "
+                      "\"median_s\": %.9f, \"p10_s\": %.9f, \"p90_s\": %.9f, \"min_s\": %.9f, \"max_s\": %.9f, "
+                      "\"mean_s\": %.9f, \"gflops\": %.4f, \"gbps\": %.4f, \"error\": %.3e, \"verified\": %s, "
+                      "\"counters\": {",
+                op_names[r->op], r->size, engine_label(r->engine), r->threads, r->stats.runs,
+                r->stats.median, r->stats.p10, r->stats.p90, r->stats.min, r->stats.max, r->stats.mean,
+                r->stats.gflops, r->stats.gbps, r->error, r->verified ? "true" : "false");
+        const perf_sample_t* counters = &r->stats.counters;
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            fprintf(file, "\"%s\": ", perf_event_name((perf_event_id_t)e));
+            if (counters->active && (counters->valid & (1u << e))) fprintf(file, "%.0f, ", counters->values[e]);
+            else fprintf(file, "null, ");
+        }
+        if (perf_sample_ipc(counters) > 0.0) fprintf(file, "\"ipc\": %.4f}}", perf_sample_ipc(counters));
+        else fprintf(file, "\"ipc\": null}}");
+        fprintf(file, "%s\n", i + 1 < records->count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+// Compares medians with a CSV written by an earlier run. Cases missing from
+// either side are ignored. Returns the number of regressions.
+static int compare_baseline(const char* path, const record_list_t* records, double threshold) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot read baseline %s\n", path);
+        return 0;
+    }
+
+    printf("\n=== BASELINE COMPARISON (%s, threshold +%.0f%%) ===\n", path, threshold * 100.0);
+    char line[512];
+    int regressions = 0, compared = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char op[32], engine[32];
+        int size, threads, runs;
+        double median;
+        if (sscanf(line, "%31[^,],%d,%31[^,],%d,%d,%lf", op, &size, engine, &threads, &runs, &median) != 6) {
+            continue;  // header or malformed line
+        }
+        for (int i = 0; i < records->count; i++) {
+            const bench_record_t* r = &records->items[i];
+            if (r->size != size || r->threads != threads || strcmp(op_names[r->op], op) != 0 ||
+                strcmp(engine_label(r->engine), engine) != 0) {
+                continue;
+            }
+            if (median < BENCH_MIN_COMPARABLE_SECONDS || r->stats.median < BENCH_MIN_COMPARABLE_SECONDS) break;
+            compared++;
+            double change = r->stats.median / median - 1.0;
+            if (change > threshold) {
+                printf("REGRESSION %-12s %6d %-11s %3d  %.6f s -> %.6f s (%+.1f%%)\n",
+                       op, size, engine, threads, median, r->stats.median, change * 100.0);
+                regressions++;
+            }
+            break;
+        }
+    }
+    fclose(file);
+    printf("%d case(s) compared, %d regression(s)\n", compared, regressions);
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    bench_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.warmup = -1;
+    options.runs = -1;
+    options.eigen_max = BENCH_DEFAULT_EIGEN_MAX;
+    options.threshold = BENCH_DEFAULT_THRESHOLD;
+    if (parse_options(argc, argv, &options) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    load_config(options.config_path);
+    if (options.warmup < 0) options.warmup = global_config.benchmark_warmup;
+    if (options.runs < 0) options.runs = global_config.benchmark_runs;
+    // Same clamp as benchmark_repeat, so completed counts compare with it.
+    if (options.runs < 1) options.runs = 1;
+    if (options.runs > BENCH_MAX_RUNS) options.runs = BENCH_MAX_RUNS;
+    simd_initialize((simd_level_t)global_config.simd_level);
+    trace_init(options.trace_path ? options.trace_path : global_config.trace_file);
+    initialize_process_pool();
+    setup_signal_handlers();
+    pool_verbose = 0;
+    perf_counters_init();
+    perf_print_available();
+
+    printf("Benchmark suite: %d size(s), %d warm-up + %d timed run(s), SIMD %s, %d pool worker(s)\n",
+           options.size_count, options.warmup, options.runs, simd_kernels.name, active_processes);
+
+    record_list_t records = { NULL, 0, 0 };
+    int mismatches = 0;
+    for (int s = 0; s < options.size_count; s++) {
+        int n = options.sizes[s];
+        matrix_t* A = create_random_matrix(n, n, "Bench_A");
+        matrix_t* B = create_random_matrix(n, n, "Bench_B");
+        matrix_t* S = NULL;
+        if (A && B && options.ops[BENCH_OP_EIGEN] && n <= options.eigen_max) {
+            S = create_matrix(n, n, "Bench_S");
+            if (S) {
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < n; j++) {
+                        S->data[i][j] = 0.5 * (A->data[i][j] + A->data[j][i]);
+                    }
+                }
+            }
+        }
+        if (!A || !B) {
+            fprintf(stderr, "Cannot allocate %dx%d operands, skipping\n", n, n);
+            free_matrix(A);
+            free_matrix(B);
+            continue;
+        }
+
+        for (int op = 0; op < BENCH_OP_COUNT; op++) {
+            if (!options.ops[op]) continue;
+            if (op == BENCH_OP_EIGEN) {
+                if (S) run_case(&options, BENCH_OP_EIGEN, n, S, NULL, &records, &mismatches);
+                continue;
+            }
+            run_case(&options, (bench_op_t)op, n, A, B, &records, &mismatches);
+        }
+        free_matrix(A);
+        free_matrix(B);
+        free_matrix(S);
+    }
+
+    int status = mismatches > 0 ? 1 : 0;
+    if (options.csv_path && write_csv(options.csv_path, &records) == 0) {
+        printf("CSV written to %s\n", options.csv_path);
+    }
+    if (options.json_path && write_json(options.json_path, &records, &options) == 0) {
+        printf("JSON written to %s\n", options.json_path);
+    }
+    if (options.baseline_path && compare_baseline(options.baseline_path, &records, options.threshold) > 0) {
+        status = 2;
+    }
+    if (mismatches > 0) {
+        printf("%d case(s) failed or disagreed with the sequential result\n", mismatches);
+    }
+
+    free(records.items);
+    perf_counters_shutdown();
+    cleanup_process_pool();
+    trace_flush();
+    return status;
+}
@@ -0,0 +1,243 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/benchmark.h"
+#include "../include/process_management.h"
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between the two sorted runs around fraction q.
+static double percentile(const double* sorted, int count, double q) {
+    double position = q * (count - 1);
+    int below = (int)position;
+    if (below >= count - 1) return sorted[count - 1];
+    double weight = position - below;
+    return sorted[below] * (1.0 - weight) + sorted[below + 1] * weight;
+}
+
+void benchmark_summarize(double* times, int runs, double flops, double bytes,
+                         bench_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (runs <= 0) return;
+
+    qsort(times, (size_t)runs, sizeof(double), compare_doubles);
+    double sum = 0.0;
+    for (int i = 0; i < runs; i++) sum += times[i];
+
+    stats->runs = runs;
+    stats->min = times[0];
+    stats->max = times[runs - 1];
+    stats->mean = sum / runs;
+    stats->p10 = percentile(times, runs, 0.10);
+    stats->median = percentile(times, runs, 0.50);
+    stats->p90 = percentile(times, runs, 0.90);
+    if (stats->median > 0.0) {
+        stats->gflops = flops / stats->median * 1e-9;
+        stats->gbps = bytes / stats->median * 1e-9;
+    }
+}
+
+void benchmark_operation_size(dispatch_op_t op, const matrix_t* A, const matrix_t* B,
+                              double* flops, double* bytes) {
+    double m = A->rows, k = A->cols;
+    switch (op) {
+        case DISPATCH_ADD:
+        case DISPATCH_SUBTRACT:
+            *flops = m * k;
+            *bytes = 3.0 * m * k * sizeof(double);
+            break;
+        case DISPATCH_MULTIPLY: {
+            double n = B->cols;
+            *flops = 2.0 * m * n * k;
+            *bytes = (m * k + k * n + m * n) * sizeof(double);
+            break;
+        }
+        case DISPATCH_DETERMINANT:
+            *flops = 2.0 / 3.0 * m * m * m;
+            *bytes = m * m * sizeof(double);
+            break;
+    }
+}
+
+void bench_output_free(bench_output_t* output) {
+    free_matrix(output->matrix);
+    free(output->values);
+    memset(output, 0, sizeof(*output));
+}
+
+// Tracks the largest difference and reference magnitude; NaN counts as
+// an infinite difference. Equal values agree even when both overflowed to
+// the same infinity, as large determinants do.
+static void accumulate_difference(double x, double ref, double* worst, double* scale) {
+    double diff = x == ref ? 0.0 : fabs(x - ref);
+    if (!(diff <= *worst)) *worst = isnan(diff) ? INFINITY : diff;
+    if (fabs(ref) > *scale) *scale = fabs(ref);
+}
+
+double bench_output_difference(const bench_output_t* x, const bench_output_t* ref) {
+    double scale = 0.0, worst = 0.0;
+    if (ref->matrix) {
+        if (!x->matrix || x->matrix->rows != ref->matrix->rows || x->matrix->cols != ref->matrix->cols) {
+            return INFINITY;
+        }
+        for (int i = 0; i < ref->matrix->rows; i++) {
+            const double* xr = MATRIX_ROW(x->matrix, i);
+            const double* rr = MATRIX_ROW(ref->matrix, i);
+            for (int j = 0; j < ref->matrix->cols; j++) {
+                accumulate_difference(xr[j], rr[j], &worst, &scale);
+            }
+        }
+    } else {
+        if (x->count != ref->count || (ref->count > 0 && !x->values)) return INFINITY;
+        for (int i = 0; i < ref->count; i++) {
+            accumulate_difference(x->values[i], ref->values[i], &worst, &scale);
+        }
+    }
+    return scale > 0.0 ? worst / scale : worst;
+}
+
+int benchmark_repeat(bench_run_fn run, void* context, int warmup, int runs,
+                     double flops, double bytes, bench_stats_t* stats, bench_output_t* last) {
+    memset(last, 0, sizeof(*last));
+    if (warmup < 0) warmup = 0;
+    if (runs < 1) runs = 1;
+    if (runs > BENCH_MAX_RUNS) runs = BENCH_MAX_RUNS;
+
+    double times[BENCH_MAX_RUNS];
+    int completed = 0;
+    perf_sample_t counters;
+    for (int i = -warmup; i < runs; i++) {
+        // Counting the batch rather than each run keeps counter reads out
+        // of the timings.
+        if (i == 0) perf_begin(&counters);
+        bench_output_t output;
+        memset(&output, 0, sizeof(output));
+        double start = monotonic_seconds();
+        int status = run(context, &output);
+        double elapsed = monotonic_seconds() - start;
+        if (status != 0) continue;
+
+        if (i >= 0) times[completed++] = elapsed;
+        bench_output_free(last);
+        *last = output;
+    }
+    perf_end(&counters);
+    benchmark_summarize(times, completed, flops, bytes, stats);
+    if (counters.active && completed > 0) {
+        perf_sample_scale(&counters, completed);
+        stats->counters = counters;
+    }
+    return completed;
+}
+
+typedef struct {
+    dispatch_op_t op;
+    engine_t engine;
+    const matrix_t* A;
+    const matrix_t* B;
+} dispatch_run_t;
+
+static int run_dispatched(void* context, bench_output_t* output) {
+    const dispatch_run_t* job = (const dispatch_run_t*)context;
+    if (job->op == DISPATCH_DETERMINANT) {
+        output->values = (double*)malloc(sizeof(double));
+        if (!output->values) return -1;
+        output->values[0] = dispatch_determinant(job->engine, job->A, NULL);
+        output->count = 1;
+        return 0;
+    }
+    output->matrix = dispatch_binary(job->op, job->engine, job->A, job->B, NULL);
+    return output->matrix ? 0 : -1;
+}
+
+int benchmark_operation(dispatch_op_t op, const matrix_t* A, const matrix_t* B,
+                        int warmup, int runs, bench_result_t* results) {
+    static const engine_t engines[BENCH_ENGINES] = { ENGINE_SEQUENTIAL, ENGINE_PROCESSES, ENGINE_OPENMP };
+    if (runs < 1) runs = 1;
+    if (runs > BENCH_MAX_RUNS) runs = BENCH_MAX_RUNS;
+
+    double flops = 0.0, bytes = 0.0;
+    benchmark_operation_size(op, A, B, &flops, &bytes);
+
+    // Worker chatter would drown the report.
+    int verbose = pool_verbose;
+    pool_verbose = 0;
+
+    bench_output_t reference;
+    memset(&reference, 0, sizeof(reference));
+    for (int e = 0; e < BENCH_ENGINES; e++) {
+        bench_result_t* result = &results[e];
+        memset(result, 0, sizeof(*result));
+        result->engine = engines[e];
+
+        dispatch_run_t job = { op, engines[e], A, B };
+        bench_output_t output;
+        int completed = benchmark_repeat(run_dispatched, &job, warmup, runs,
+                                         flops, bytes, &result->stats, &output);
+        result->ok = completed == runs;
+
+        if (e == 0) {
+            // The sequential engine is the reference for the others.
+            reference = output;
+            result->verified = result->ok;
+            result->speedup = result->ok ? 1.0 : 0.0;
+            continue;
+        }
+
+        if (result->ok && results[0].ok) {
+            result->error = bench_output_difference(&output, &reference);
+            result->verified = result->error <= BENCH_VERIFY_TOLERANCE;
+            if (result->stats.median > 0.0) {
+                result->speedup = results[0].stats.median / result->stats.median;
+            }
+        }
+        bench_output_free(&output);
+    }
+
+    pool_verbose = verbose;
+    bench_output_free(&reference);
+    return results[0].ok ? 0 : -1;
+}
+
+void benchmark_print(const char* title, const bench_result_t* results, int count) {
+    printf("\n=== %s (median of %d runs, wall clock) ===\n", title,
+           count > 0 ? results[0].stats.runs : 0);
+    printf("%-19s %11s %11s %11s %9s %8s %8s  %s\n",
+           "Engine", "Median (s)", "P10 (s)", "P90 (s)", "GFLOP/s", "GB/s", "Speedup", "Check");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t* r = &results[i];
+        if (!r->ok) {
+            printf("%-19s FAILED\n", engine_name(r->engine));
+            continue;
+        }
+        printf("%-19s %11.6f %11.6f %11.6f %9.3f %8.3f %7.2fx  ",
+               engine_name(r->engine), r->stats.median, r->stats.p10, r->stats.p90,
+               r->stats.gflops, r->stats.gbps, r->speedup);
+        if (i == 0) {
+            printf("reference\n");
+        } else if (!results[0].ok) {
+            printf("unchecked\n");
+        } else if (r->verified) {
+            printf("ok (%.1e)\n", r->error);
+        } else {
+            printf("MISMATCH (%.1e)\n", r->error);
+        }
+    }
+
+    int counted = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i].ok && results[i].stats.counters.active) counted = 1;
+    }
+    if (!counted) return;
+    printf("\nHardware counters per run:\n");
+    perf_print_header("Engine");
+    for (int i = 0; i < count; i++) {
+        if (results[i].ok) perf_print_row(engine_name(results[i].engine), &results[i].stats.counters);
+    }
+}
@@ -8,7 +8,7 @@ config_t global_config;
 void initialize_default_config() {
 
     strcpy(global_config.matrix_directory, "./matrices");
-    global_config.max_matrices = MAX_MATRICES;
+    global_config.max_matrices = 0;  // unlimited
     global_config.process_pool_size = 5;
     global_config.use_openmp = 1;
     global_config.custom_menu = 0;
@@ -23,16 +23,23 @@ void initialize_default_config() {
     global_config.performance_test_size = 30;
     global_config.openmp_threads = 4;
     global_config.enable_process_pool = 1;
+    global_config.simd_level = 0;
+    global_config.benchmark_warmup = 1;
+    global_config.benchmark_runs = 5;
+    global_config.perf_counters = 1;
     global_config.show_timings = 1;
+    global_config.trace_file[0] = '\0';
     global_config.auto_save_interval = 5;
     global_config.auto_load_on_startup = 1;
     global_config.create_backups = 1;
     global_config.enable_memory_check = 1;
     global_config.cache_size = 200;
+    global_config.save_binary = 1;
+    global_config.verify_checksums = 1;
     global_config.eigen_tolerance = 1e-12;
     global_config.eigen_max_iterations = 2000;
-    global_config.determinant_method = 1;
-    global_config.multiplication_method = 2;
+    global_config.determinant_method = 0;
+    global_config.multiplication_method = 0;
 }
 
 void load_config(const char* filename) {
@@ -93,9 +100,24 @@ void load_config(const char* filename) {
         else if (strcmp(trimmed_key, "enable_process_pool") == 0) {
             global_config.enable_process_pool = atoi(trimmed_value);
         }
+        else if (strcmp(trimmed_key, "simd_level") == 0) {
+            global_config.simd_level = atoi(trimmed_value);
+        }
+        else if (strcmp(trimmed_key, "benchmark_warmup") == 0) {
+            global_config.benchmark_warmup = atoi(trimmed_value);
+        }
+        else if (strcmp(trimmed_key, "benchmark_runs") == 0) {
+            global_config.benchmark_runs = atoi(trimmed_value);
+        }
+        else if (strcmp(trimmed_key, "perf_counters") == 0) {
+            global_config.perf_counters = atoi(trimmed_value);
+        }
         else if (strcmp(trimmed_key, "show_timings") == 0) {
             global_config.show_timings = atoi(trimmed_value);
         }
+        else if (strcmp(trimmed_key, "trace_file") == 0) {
+            snprintf(global_config.trace_file, sizeof(global_config.trace_file), "%s", trimmed_value);
+        }
         else if (strcmp(trimmed_key, "auto_save_interval") == 0) {
             global_config.auto_save_interval = atoi(trimmed_value);
         }
@@ -111,6 +133,12 @@ void load_config(const char* filename) {
         else if (strcmp(trimmed_key, "cache_size") == 0) {
             global_config.cache_size = atoi(trimmed_value);
         }
+        else if (strcmp(trimmed_key, "save_binary") == 0) {
+            global_config.save_binary = atoi(trimmed_value);
+        }
+        else if (strcmp(trimmed_key, "verify_checksums") == 0) {
+            global_config.verify_checksums = atoi(trimmed_value);
+        }
         else if (strcmp(trimmed_key, "eigen_tolerance") == 0) {
             global_config.eigen_tolerance = atof(trimmed_value);
         }
@@ -174,9 +202,14 @@ void save_config(const char* filename) {
     fprintf(file, "performance_test_size=%d\n", global_config.performance_test_size);
     fprintf(file, "openmp_threads=%d\n", global_config.openmp_threads);
     fprintf(file, "enable_process_pool=%d\n", global_config.enable_process_pool);
+    fprintf(file, "simd_level=%d\n", global_config.simd_level);
+    fprintf(file, "benchmark_warmup=%d\n", global_config.benchmark_warmup);
+    fprintf(file, "benchmark_runs=%d\n", global_config.benchmark_runs);
+    fprintf(file, "perf_counters=%d\n", global_config.perf_counters);
     
     fprintf(file, "\n# UI Settings\n");
     fprintf(file, "show_timings=%d\n", global_config.show_timings);
+    fprintf(file, "trace_file=%s\n", global_config.trace_file);
     fprintf(file, "auto_save_interval=%d\n", global_config.auto_save_interval);
     fprintf(file, "auto_load_on_startup=%d\n", global_config.auto_load_on_startup);
     fprintf(file, "create_backups=%d\n", global_config.create_backups);
@@ -184,6 +217,8 @@ void save_config(const char* filename) {
     fprintf(file, "\n# Memory Settings\n");
     fprintf(file, "enable_memory_check=%d\n", global_config.enable_memory_check);
     fprintf(file, "cache_size=%d\n", global_config.cache_size);
+    fprintf(file, "save_binary=%d\n", global_config.save_binary);
+    fprintf(file, "verify_checksums=%d\n", global_config.verify_checksums);
     
     fprintf(file, "\n# Algorithm Settings\n");
     fprintf(file, "eigen_tolerance=%.12f\n", global_config.eigen_tolerance);
@@ -209,7 +244,11 @@ void print_config() {
     printf("\n=== Current Configuration ===\n");
     printf("Matrix Directory: %s\n", global_config.matrix_directory);
     printf("Use OpenMP: %s\n", global_config.use_openmp ? "Yes" : "No");
-    printf("Max Matrices: %d\n", global_config.max_matrices);
+    if (global_config.max_matrices > 0) {
+        printf("Max Matrices: %d\n", global_config.max_matrices);
+    } else {
+        printf("Max Matrices: unlimited\n");
+    }
     printf("Process Pool Size: %d\n", global_config.process_pool_size);
     printf("Max Processes: %d\n", global_config.max_processes);  
     printf("Custom Menu: %s\n", global_config.custom_menu ? "Yes" : "No");
@@ -218,9 +257,14 @@ void print_config() {
     printf("  Test Size: %d\n", global_config.performance_test_size);
     printf("  OpenMP Threads: %d\n", global_config.openmp_threads);
     printf("  Process Pool: %s\n", global_config.enable_process_pool ? "Enabled" : "Disabled");
+    printf("  SIMD Level: %d (0=auto, 1=scalar, 2=AVX2, 3=AVX-512)\n", global_config.simd_level);
+    printf("  Benchmark Runs: %d warm-up + %d timed\n", global_config.benchmark_warmup,
+           global_config.benchmark_runs);
+    printf("  Hardware Counters: %s\n", global_config.perf_counters ? "Enabled" : "Disabled");
     
     printf("\nUI Settings:\n");
     printf("  Show Timings: %s\n", global_config.show_timings ? "Yes" : "No");
+    printf("  Trace File: %s\n", global_config.trace_file[0] ? global_config.trace_file : "(off)");
     printf("  Auto Save: %d minutes\n", global_config.auto_save_interval);
     printf("  Auto Load: %s\n", global_config.auto_load_on_startup ? "Yes" : "No");
     printf("  Create Backups: %s\n", global_config.create_backups ? "Yes" : "No");
@@ -228,12 +272,16 @@ void print_config() {
     printf("\nMemory Settings:\n");
     printf("  Memory Check: %s\n", global_config.enable_memory_check ? "Enabled" : "Disabled");
     printf("  Cache Size: %d\n", global_config.cache_size);
+    printf("  Save Format: %s\n", global_config.save_binary ? "binary .mat" : "text .txt");
+    printf("  Verify Checksums: %s\n", global_config.verify_checksums ? "Yes" : "No");
     
     printf("\nAlgorithm Settings:\n");
     printf("  Eigen Tolerance: %.2e\n", global_config.eigen_tolerance);
     printf("  Eigen Max Iterations: %d\n", global_config.eigen_max_iterations);
-    printf("  Determinant Method: %d\n", global_config.determinant_method);
-    printf("  Multiplication Method: %d\n", global_config.multiplication_method);
+    printf("  Determinant Method: %d (0=auto, 1=sequential, 2=processes, 3=OpenMP)\n",
+           global_config.determinant_method);
+    printf("  Multiplication Method: %d (0=auto, 1=sequential, 2=processes, 3=OpenMP)\n",
+           global_config.multiplication_method);
     
     if (global_config.custom_menu) {
         printf("Menu Order: ");
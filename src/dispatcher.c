@@ -0,0 +1,346 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/dispatcher.h"
+#include "../include/config.h"
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/lu_decomposition.h"
+#include "../include/openmp_utils.h"
+#include "../include/process_management.h"
+#include "../include/perf_counters.h"
+
+dispatch_model_t dispatch_model;
+
+// Floor on measured times so a coarse clock never yields an infinite rate.
+static double at_least(double seconds) {
+    return seconds > 1e-7 ? seconds : 1e-7;
+}
+
+// Best of three runs of C = A * B at the calibration size.
+static double time_gemm(const double* A, const double* B, double* C, int parallel) {
+    int n = DISPATCH_CALIBRATION_GEMM;
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        memset(C, 0, (size_t)n * n * sizeof(double));
+        double start = monotonic_seconds();
+        gemm_compute(n, n, n, 1.0, A, n, B, n, C, n, parallel);
+        double elapsed = monotonic_seconds() - start;
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+    return at_least(best);
+}
+
+// Best of three c = a + b passes, split into row-sized chunks like the
+// element-wise kernels.
+static double time_stream(const double* a, const double* b, double* c, int parallel) {
+    int chunk = 1024;
+    int chunks = DISPATCH_CALIBRATION_STREAM / chunk;
+    double best = 0.0;
+    (void)parallel;
+    for (int run = 0; run < 3; run++) {
+        double start = monotonic_seconds();
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if(parallel)
+        #endif
+        for (int i = 0; i < chunks; i++) {
+            size_t offset = (size_t)i * chunk;
+            simd_kernels.vector_add(a + offset, b + offset, c + offset, chunk);
+        }
+        double elapsed = monotonic_seconds() - start;
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+    return at_least(best);
+}
+
+// Best of three first-touch passes over a fresh anonymous mapping, which is
+// what filling a new shared-memory arena costs.
+static double time_page_faults(size_t bytes) {
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        void* region = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) return 0.0;
+        double start = monotonic_seconds();
+        memset(region, 1, bytes);
+        double elapsed = monotonic_seconds() - start;
+        munmap(region, bytes);
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+    return at_least(best);
+}
+
+// Average cost of 100 empty parallel regions, or of 100 barriers inside a
+// single region when barriers_only is set.
+static double time_synchronisation(int barriers_only) {
+    double best = 0.0;
+    #ifdef _OPENMP
+    for (int run = 0; run < 3; run++) {
+        double start = monotonic_seconds();
+        if (barriers_only) {
+            #pragma omp parallel
+            {
+                for (int i = 0; i < 100; i++) {
+                    #pragma omp barrier
+                }
+            }
+        } else {
+            for (int i = 0; i < 100; i++) {
+                #pragma omp parallel
+                {
+                    #pragma omp barrier
+                }
+            }
+        }
+        double elapsed = (monotonic_seconds() - start) / 100;
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+    #else
+    (void)barriers_only;
+    #endif
+    return best;
+}
+
+void dispatcher_calibrate(void) {
+    dispatch_model_t* model = &dispatch_model;
+    memset(model, 0, sizeof(*model));
+    model->threads = get_optimal_thread_count();
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    model->cores = cores > 0 ? (int)cores : 1;
+
+    size_t gemm_elements = (size_t)DISPATCH_CALIBRATION_GEMM * DISPATCH_CALIBRATION_GEMM;
+    size_t stream_elements = DISPATCH_CALIBRATION_STREAM;
+    double* A = (double*)malloc(3 * gemm_elements * sizeof(double));
+    double* a = (double*)malloc(3 * stream_elements * sizeof(double));
+    if (!A || !a) {
+        free(A);
+        free(a);
+        // Without measurements, fall back to rates of a modest machine.
+        model->gemm_rate = 5e9;
+        model->omp_gemm_rate = 5e9 * model->threads;
+        model->stream_rate = 5e9;
+        model->omp_stream_rate = 1e10;
+        model->fault_rate = 2e9;
+        model->omp_overhead = 5e-6;
+        model->omp_barrier = 2e-6;
+    } else {
+        for (size_t i = 0; i < 2 * gemm_elements; i++) A[i] = (double)(i % 7) - 3.0;
+        for (size_t i = 0; i < 2 * stream_elements; i++) a[i] = (double)(i % 5);
+        double* B = A + gemm_elements;
+        double* C = B + gemm_elements;
+        double* b = a + stream_elements;
+        double* c = b + stream_elements;
+
+        double flops = 2.0 * gemm_elements * DISPATCH_CALIBRATION_GEMM;
+        double bytes = 3.0 * stream_elements * sizeof(double);
+        // Single-thread rates first: idle OpenMP threads keep spinning for a
+        // while after a region and would slow them down on few cores.
+        model->gemm_rate = flops / time_gemm(A, B, C, 0);
+        model->stream_rate = bytes / time_stream(a, b, c, 0);
+        model->omp_overhead = time_synchronisation(0);
+        model->omp_barrier = time_synchronisation(1);
+        model->omp_gemm_rate = flops / at_least(time_gemm(A, B, C, 1) - model->omp_overhead);
+        model->omp_stream_rate = bytes / at_least(time_stream(a, b, c, 1) - model->omp_overhead);
+        // Timing noise must not promise more speedup than the cores allow.
+        int lanes = model->threads < model->cores ? model->threads : model->cores;
+        if (model->omp_gemm_rate > model->gemm_rate * lanes) model->omp_gemm_rate = model->gemm_rate * lanes;
+        if (model->omp_stream_rate > model->stream_rate * lanes) model->omp_stream_rate = model->stream_rate * lanes;
+        size_t fault_bytes = stream_elements * sizeof(double);
+        double fault_time = time_page_faults(fault_bytes);
+        model->fault_rate = fault_time > 0.0 ? fault_bytes / fault_time : model->stream_rate;
+        free(A);
+        free(a);
+    }
+
+    // The probe builds scratch matrices; keep it from using up registry IDs.
+    int saved_id = next_matrix_id;
+    model->pool_overhead = -1.0;
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        double start = monotonic_seconds();
+        int workers = pool_probe();
+        double elapsed = monotonic_seconds() - start;
+        if (workers < 0) break;
+        model->workers = workers > model->workers ? workers : model->workers;
+        if (run == 0 || elapsed < best) best = elapsed;
+        model->pool_overhead = best;
+    }
+    next_matrix_id = saved_id;
+
+    model->calibrated = 1;
+}
+
+void dispatcher_print_model(void) {
+    const dispatch_model_t* model = &dispatch_model;
+    printf("Dispatcher: GEMM %.1f GFLOP/s (1 thread), %.1f GFLOP/s (%d threads), "
+           "stream %.1f/%.1f GB/s, faults %.1f GB/s, region %.1f us, barrier %.1f us, %d cores",
+           model->gemm_rate * 1e-9, model->omp_gemm_rate * 1e-9, model->threads,
+           model->stream_rate * 1e-9, model->omp_stream_rate * 1e-9, model->fault_rate * 1e-9,
+           model->omp_overhead * 1e6, model->omp_barrier * 1e6, model->cores);
+    if (model->pool_overhead >= 0.0) {
+        printf(", pool %.1f us (%d workers)\n", model->pool_overhead * 1e6, model->workers);
+    } else {
+        printf(", pool unavailable\n");
+    }
+}
+
+const char* engine_name(engine_t engine) {
+    switch (engine) {
+        case ENGINE_AUTO: return "auto";
+        case ENGINE_SEQUENTIAL: return "sequential";
+        case ENGINE_PROCESSES: return "parallel processes";
+        case ENGINE_OPENMP: return "OpenMP";
+    }
+    return "unknown";
+}
+
+static int engine_available(engine_t engine) {
+    switch (engine) {
+        case ENGINE_SEQUENTIAL: return 1;
+        case ENGINE_OPENMP: return is_openmp_enabled() && dispatch_model.threads > 1;
+        case ENGINE_PROCESSES: return dispatch_model.pool_overhead >= 0.0 && dispatch_model.workers > 0;
+        default: return 0;
+    }
+}
+
+double dispatcher_estimate(dispatch_op_t op, engine_t engine,
+                           const matrix_t* A, const matrix_t* B) {
+    if (!dispatch_model.calibrated) dispatcher_calibrate();
+    const dispatch_model_t* model = &dispatch_model;
+    // Workers beyond the core count only time-slice.
+    int workers = model->workers < model->cores ? model->workers : model->cores;
+    if (workers < 1) workers = 1;
+
+    if (op == DISPATCH_ADD || op == DISPATCH_SUBTRACT) {
+        double bytes = 3.0 * A->rows * A->cols * sizeof(double);
+        switch (engine) {
+            case ENGINE_OPENMP:
+                return model->omp_overhead + bytes / model->omp_stream_rate;
+            case ENGINE_PROCESSES:
+                // Operands and result live in a fresh arena.
+                return model->pool_overhead + bytes / model->fault_rate +
+                       bytes / (model->stream_rate * workers);
+            default:
+                return bytes / model->stream_rate;
+        }
+    }
+
+    if (op == DISPATCH_MULTIPLY) {
+        double m = A->rows, k = A->cols, n = B->cols;
+        double flops = 2.0 * m * n * k;
+        // gemm_compute keeps small products on the calling thread.
+        if (m * n * k < GEMM_SMALL_WORK && engine == ENGINE_OPENMP) engine = ENGINE_SEQUENTIAL;
+        switch (engine) {
+            case ENGINE_OPENMP:
+                return model->omp_overhead + flops / model->omp_gemm_rate;
+            case ENGINE_PROCESSES:
+                return model->pool_overhead + (m * k + k * n + m * n) * sizeof(double) / model->fault_rate +
+                       flops / (model->gemm_rate * workers);
+            default:
+                return flops / model->gemm_rate;
+        }
+    }
+
+    // Blocked LU: panels and row-block solves are O(n^2 * LU_BLOCK_SIZE),
+    // the trailing updates carry the remaining ~2/3 n^3 flops.
+    double n = A->rows;
+    double blocks = (n + LU_BLOCK_SIZE - 1) / LU_BLOCK_SIZE;
+    double panel_flops = n * n * LU_BLOCK_SIZE;
+    double update_flops = 2.0 / 3.0 * n * n * n;
+    if (n <= 3) return 0.0;
+    switch (engine) {
+        case ENGINE_OPENMP:
+            if (n < LU_PARALLEL_MIN_ROWS) {
+                return (blocks + 1) * model->omp_overhead + panel_flops / model->gemm_rate +
+                       update_flops / model->omp_gemm_rate;
+            }
+            // Large panels pass four barriers per column.
+            return 2.0 * blocks * model->omp_overhead + 4.0 * n * model->omp_barrier +
+                   (panel_flops + update_flops) / model->omp_gemm_rate;
+        case ENGINE_PROCESSES:
+            if (n < 2 * LU_BLOCK_SIZE) break;
+            return blocks * model->pool_overhead + n * n * sizeof(double) / model->fault_rate +
+                   panel_flops / model->gemm_rate + update_flops / (model->gemm_rate * workers);
+        default:
+            break;
+    }
+    return (panel_flops + update_flops) / model->gemm_rate;
+}
+
+engine_t dispatcher_choose(dispatch_op_t op, const matrix_t* A, const matrix_t* B) {
+    int forced = ENGINE_AUTO;
+    if (op == DISPATCH_MULTIPLY) forced = global_config.multiplication_method;
+    if (op == DISPATCH_DETERMINANT) forced = global_config.determinant_method;
+    if (forced >= ENGINE_SEQUENTIAL && forced <= ENGINE_OPENMP) return (engine_t)forced;
+
+    static const engine_t candidates[] = { ENGINE_SEQUENTIAL, ENGINE_OPENMP, ENGINE_PROCESSES };
+    engine_t best = ENGINE_SEQUENTIAL;
+    double best_time = dispatcher_estimate(op, best, A, B);
+    for (int i = 1; i < 3; i++) {
+        if (!engine_available(candidates[i])) continue;
+        double estimate = dispatcher_estimate(op, candidates[i], A, B);
+        if (estimate < best_time) {
+            best = candidates[i];
+            best_time = estimate;
+        }
+    }
+    return best;
+}
+
+static matrix_t* run_binary(dispatch_op_t op, engine_t engine,
+                            const matrix_t* A, const matrix_t* B) {
+    switch (op) {
+        case DISPATCH_ADD:
+            if (engine == ENGINE_PROCESSES) return add_matrices_parallel(A, B);
+            if (engine == ENGINE_OPENMP) return add_matrices_openmp(A, B);
+            return add_matrices_seq(A, B);
+        case DISPATCH_SUBTRACT:
+            if (engine == ENGINE_PROCESSES) return subtract_matrices_parallel(A, B);
+            if (engine == ENGINE_OPENMP) return subtract_matrices_openmp(A, B);
+            return subtract_matrices_seq(A, B);
+        case DISPATCH_MULTIPLY:
+            if (engine == ENGINE_PROCESSES) return multiply_matrices_parallel(A, B);
+            if (engine == ENGINE_OPENMP) return multiply_matrices_openmp(A, B);
+            return multiply_matrices_seq(A, B);
+        default:
+            return NULL;
+    }
+}
+
+static double run_determinant(engine_t engine, const matrix_t* matrix) {
+    if (engine == ENGINE_PROCESSES) return matrix_determinant_parallel(matrix);
+    if (engine == ENGINE_OPENMP) return matrix_determinant_openmp(matrix);
+    return matrix_determinant_seq(matrix);
+}
+
+// Engine calls are bracketed by hardware counters, credited to the engine
+// that ran.
+matrix_t* dispatch_binary(dispatch_op_t op, engine_t engine,
+                          const matrix_t* A, const matrix_t* B, engine_t* used) {
+    if (engine == ENGINE_AUTO) engine = dispatcher_choose(op, A, B);
+    if (used) *used = engine;
+
+    perf_sample_t counters;
+    perf_begin(&counters);
+    matrix_t* result = run_binary(op, engine, A, B);
+    perf_end(&counters);
+    perf_record_engine(engine, &counters);
+    return result;
+}
+
+double dispatch_determinant(engine_t engine, const matrix_t* matrix, engine_t* used) {
+    if (engine == ENGINE_AUTO) engine = dispatcher_choose(DISPATCH_DETERMINANT, matrix, NULL);
+    if (used) *used = engine;
+
+    perf_sample_t counters;
+    perf_begin(&counters);
+    double det = run_determinant(engine, matrix);
+    perf_end(&counters);
+    perf_record_engine(engine, &counters);
+    return det;
+}
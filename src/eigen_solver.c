@@ -0,0 +1,1088 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "../include/eigen_solver.h"
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/config.h"
+
+// Dense square work arrays share one leading dimension. H is the matrix
+// being reduced; Vt holds the accumulated orthogonal transformations
+// transposed, so the columns the QR sweeps touch are contiguous rows.
+typedef struct {
+    int n;
+    int ld;
+    double* H;
+    double* Vt;
+    double* d;  // real parts of the eigenvalues
+    double* e;  // imaginary parts of the eigenvalues
+    int parallel;
+} eigen_workspace_t;
+
+#define H_AT(ws, i, j) ((ws)->H[(size_t)(i) * (ws)->ld + (j)])
+#define VT_AT(ws, i, j) ((ws)->Vt[(size_t)(i) * (ws)->ld + (j)])
+
+static int min_int(int a, int b) {
+    return a < b ? a : b;
+}
+
+static double* eigen_alloc(size_t count) {
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, MATRIX_ALIGNMENT, count * sizeof(double)) != 0) {
+        return NULL;
+    }
+    memset(buffer, 0, count * sizeof(double));
+    return (double*)buffer;
+}
+
+/* ---------------- Householder reduction to Hessenberg form ---------------- */
+
+// A[0:rows, 0:cols] -= u * (u^T A) / h. work receives u^T A, accumulated
+// row by row inside independent column chunks.
+static void householder_left(double* A, int ld, int rows, int cols,
+                             const double* u, double h, double* work, int parallel) {
+    int chunks = (cols + EIGEN_HOUSEHOLDER_CHUNK - 1) / EIGEN_HOUSEHOLDER_CHUNK;
+    (void)parallel;
+
+    #ifdef _OPENMP
+    #pragma omp parallel if(parallel && rows >= EIGEN_PARALLEL_MIN_ROWS)
+    #endif
+    {
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            int col = chunk * EIGEN_HOUSEHOLDER_CHUNK;
+            int width = min_int(EIGEN_HOUSEHOLDER_CHUNK, cols - col);
+            memset(work + col, 0, width * sizeof(double));
+            for (int i = 0; i < rows; i++) {
+                simd_kernels.vector_axpy(u[i], A + (size_t)i * ld + col, work + col, width);
+            }
+        }
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int i = 0; i < rows; i++) {
+            simd_kernels.vector_axpy(-u[i] / h, work, A + (size_t)i * ld, cols);
+        }
+    }
+}
+
+// A[0:rows, 0:cols] -= (A u) * u^T / h, one independent row at a time.
+static void householder_right(double* A, int ld, int rows, int cols,
+                              const double* u, double h, int parallel) {
+    (void)parallel;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if(parallel && rows >= EIGEN_PARALLEL_MIN_ROWS)
+    #endif
+    for (int i = 0; i < rows; i++) {
+        double* row = A + (size_t)i * ld;
+        double f = simd_kernels.vector_dot(row, u, cols) / h;
+        simd_kernels.vector_axpy(-f, u, row, cols);
+    }
+}
+
+// Orthogonal similarity reduction H = V^T A V to upper Hessenberg form
+// (EISPACK orthes), with V accumulated into Vt.
+static int hessenberg_reduce(eigen_workspace_t* ws) {
+    int n = ws->n;
+    int ld = ws->ld;
+    double* ort = eigen_alloc((size_t)n);
+    double* work = eigen_alloc((size_t)n);
+    if (!ort || !work) {
+        free(ort);
+        free(work);
+        return -1;
+    }
+
+    for (int m = 1; m < n - 1; m++) {
+        double scale = 0.0;
+        for (int i = m; i < n; i++) {
+            scale += fabs(H_AT(ws, i, m - 1));
+        }
+        if (scale == 0.0) continue;
+
+        double h = 0.0;
+        for (int i = n - 1; i >= m; i--) {
+            ort[i] = H_AT(ws, i, m - 1) / scale;
+            h += ort[i] * ort[i];
+        }
+        double g = sqrt(h);
+        if (ort[m] > 0) g = -g;
+        h -= ort[m] * g;
+        ort[m] -= g;
+
+        householder_left(&H_AT(ws, m, m), ld, n - m, n - m, ort + m, h, work, ws->parallel);
+        householder_right(&H_AT(ws, 0, m), ld, n, n - m, ort + m, h, ws->parallel);
+
+        ort[m] *= scale;
+        H_AT(ws, m, m - 1) = scale * g;
+    }
+
+    for (int i = 0; i < n; i++) {
+        memset(&VT_AT(ws, i, 0), 0, n * sizeof(double));
+        VT_AT(ws, i, i) = 1.0;
+    }
+
+    // Accumulate the reflectors back to front; the vectors are still stored
+    // below the subdiagonal of H.
+    for (int m = n - 2; m >= 1; m--) {
+        double pivot = H_AT(ws, m, m - 1);
+        if (pivot == 0.0) continue;
+
+        for (int i = m + 1; i < n; i++) {
+            ort[i] = H_AT(ws, i, m - 1);
+        }
+        double denominator = ort[m];
+        int len = n - m;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if(ws->parallel && len >= EIGEN_PARALLEL_MIN_ROWS)
+        #endif
+        for (int j = m; j < n; j++) {
+            double* row = &VT_AT(ws, j, m);
+            // Two divisions avoid underflow of ort[m] * pivot.
+            double g = simd_kernels.vector_dot(ort + m, row, len) / denominator / pivot;
+            simd_kernels.vector_axpy(g, ort + m, row, len);
+        }
+    }
+
+    for (int i = 2; i < n; i++) {
+        memset(&H_AT(ws, i, 0), 0, (i - 1) * sizeof(double));
+    }
+
+    free(ort);
+    free(work);
+    return 0;
+}
+
+/* ---------------- Francis double-shift QR ---------------- */
+
+static void complex_divide(double xr, double xi, double yr, double yi, double* qr, double* qi) {
+    double r, d;
+    if (fabs(yr) > fabs(yi)) {
+        r = yi / yr;
+        d = yr + r * yi;
+        *qr = (xr + r * xi) / d;
+        *qi = (xi - r * xr) / d;
+    } else {
+        r = yr / yi;
+        d = yi + r * yr;
+        *qr = (r * xr + xi) / d;
+        *qi = (r * xi - xr) / d;
+    }
+}
+
+// Reduces the Hessenberg H to real Schur form (EISPACK hqr2), updating Vt,
+// and stores the eigenvalues in d + i*e. Returns the matrix norm used by
+// the back-substitution, or -1 when the iteration budget runs out.
+static double schur_reduce(eigen_workspace_t* ws) {
+    int nn = ws->n;
+    int n = nn - 1;
+    int low = 0;
+    int high = nn - 1;
+    double eps = DBL_EPSILON;
+    double exshift = 0.0;
+    double p = 0, q = 0, r = 0, s = 0, z = 0, w, x, y;
+    double* d = ws->d;
+    double* e = ws->e;
+    long budget = (long)EIGEN_QR_STEPS_PER_VALUE * (nn > 10 ? nn : 10);
+
+    double norm = 0.0;
+    for (int i = 0; i < nn; i++) {
+        for (int j = (i > 0 ? i - 1 : 0); j < nn; j++) {
+            norm += fabs(H_AT(ws, i, j));
+        }
+    }
+
+    int iter = 0;
+    while (n >= low) {
+        // Look for a single small subdiagonal element.
+        int l = n;
+        while (l > low) {
+            s = fabs(H_AT(ws, l - 1, l - 1)) + fabs(H_AT(ws, l, l));
+            if (s == 0.0) s = norm;
+            if (fabs(H_AT(ws, l, l - 1)) <= eps * s) break;
+            l--;
+        }
+
+        if (l == n) {
+            // One real root deflated.
+            H_AT(ws, n, n) += exshift;
+            d[n] = H_AT(ws, n, n);
+            e[n] = 0.0;
+            n--;
+            iter = 0;
+        } else if (l == n - 1) {
+            // A 2x2 block deflated.
+            w = H_AT(ws, n, n - 1) * H_AT(ws, n - 1, n);
+            p = (H_AT(ws, n - 1, n - 1) - H_AT(ws, n, n)) / 2.0;
+            q = p * p + w;
+            z = sqrt(fabs(q));
+            H_AT(ws, n, n) += exshift;
+            H_AT(ws, n - 1, n - 1) += exshift;
+            x = H_AT(ws, n, n);
+
+            if (q >= 0) {
+                // Real pair: split the block with a Givens rotation.
+                z = (p >= 0) ? p + z : p - z;
+                d[n - 1] = x + z;
+                d[n] = d[n - 1];
+                if (z != 0.0) d[n] = x - w / z;
+                e[n - 1] = 0.0;
+                e[n] = 0.0;
+                x = H_AT(ws, n, n - 1);
+                s = fabs(x) + fabs(z);
+                p = x / s;
+                q = z / s;
+                r = sqrt(p * p + q * q);
+                p /= r;
+                q /= r;
+
+                for (int j = n - 1; j < nn; j++) {
+                    z = H_AT(ws, n - 1, j);
+                    H_AT(ws, n - 1, j) = q * z + p * H_AT(ws, n, j);
+                    H_AT(ws, n, j) = q * H_AT(ws, n, j) - p * z;
+                }
+                for (int i = 0; i <= n; i++) {
+                    z = H_AT(ws, i, n - 1);
+                    H_AT(ws, i, n - 1) = q * z + p * H_AT(ws, i, n);
+                    H_AT(ws, i, n) = q * H_AT(ws, i, n) - p * z;
+                }
+                double* v0 = &VT_AT(ws, n - 1, 0);
+                double* v1 = &VT_AT(ws, n, 0);
+                for (int i = low; i <= high; i++) {
+                    z = v0[i];
+                    v0[i] = q * z + p * v1[i];
+                    v1[i] = q * v1[i] - p * z;
+                }
+            } else {
+                // Complex conjugate pair.
+                d[n - 1] = x + p;
+                d[n] = x + p;
+                e[n - 1] = z;
+                e[n] = -z;
+            }
+            n -= 2;
+            iter = 0;
+        } else {
+            if (--budget < 0) return -1.0;
+
+            // Form the shift.
+            x = H_AT(ws, n, n);
+            y = 0.0;
+            w = 0.0;
+            if (l < n) {
+                y = H_AT(ws, n - 1, n - 1);
+                w = H_AT(ws, n, n - 1) * H_AT(ws, n - 1, n);
+            }
+
+            // Exceptional shifts break cycles the standard shift gets stuck in.
+            if (iter == 10) {
+                exshift += x;
+                for (int i = low; i <= n; i++) {
+                    H_AT(ws, i, i) -= x;
+                }
+                s = fabs(H_AT(ws, n, n - 1)) + fabs(H_AT(ws, n - 1, n - 2));
+                x = y = 0.75 * s;
+                w = -0.4375 * s * s;
+            }
+            if (iter == 30) {
+                s = (y - x) / 2.0;
+                s = s * s + w;
+                if (s > 0) {
+                    s = sqrt(s);
+                    if (y < x) s = -s;
+                    s = x - w / ((y - x) / 2.0 + s);
+                    for (int i = low; i <= n; i++) {
+                        H_AT(ws, i, i) -= s;
+                    }
+                    exshift += s;
+                    x = y = w = 0.964;
+                }
+            }
+            iter++;
+
+            // Look for two consecutive small subdiagonal elements.
+            int m = n - 2;
+            while (m >= l) {
+                z = H_AT(ws, m, m);
+                r = x - z;
+                s = y - z;
+                p = (r * s - w) / H_AT(ws, m + 1, m) + H_AT(ws, m, m + 1);
+                q = H_AT(ws, m + 1, m + 1) - z - r - s;
+                r = H_AT(ws, m + 2, m + 1);
+                s = fabs(p) + fabs(q) + fabs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l) break;
+                if (fabs(H_AT(ws, m, m - 1)) * (fabs(q) + fabs(r)) <
+                    eps * (fabs(p) * (fabs(H_AT(ws, m - 1, m - 1)) + fabs(z) + fabs(H_AT(ws, m + 1, m + 1))))) {
+                    break;
+                }
+                m--;
+            }
+
+            for (int i = m + 2; i <= n; i++) {
+                H_AT(ws, i, i - 2) = 0.0;
+                if (i > m + 2) H_AT(ws, i, i - 3) = 0.0;
+            }
+
+            // Chase the bulge through rows l..n and columns m..n.
+            for (int k = m; k <= n - 1; k++) {
+                int notlast = (k != n - 1);
+                if (k != m) {
+                    p = H_AT(ws, k, k - 1);
+                    q = H_AT(ws, k + 1, k - 1);
+                    r = notlast ? H_AT(ws, k + 2, k - 1) : 0.0;
+                    x = fabs(p) + fabs(q) + fabs(r);
+                    if (x == 0.0) continue;
+                    p /= x;
+                    q /= x;
+                    r /= x;
+                }
+
+                s = sqrt(p * p + q * q + r * r);
+                if (p < 0) s = -s;
+                if (s == 0) continue;
+
+                if (k != m) {
+                    H_AT(ws, k, k - 1) = -s * x;
+                } else if (l != m) {
+                    H_AT(ws, k, k - 1) = -H_AT(ws, k, k - 1);
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+
+                double* row0 = &H_AT(ws, k, 0);
+                double* row1 = &H_AT(ws, k + 1, 0);
+                double* row2 = notlast ? &H_AT(ws, k + 2, 0) : NULL;
+                for (int j = k; j < nn; j++) {
+                    p = row0[j] + q * row1[j];
+                    if (notlast) {
+                        p += r * row2[j];
+                        row2[j] -= p * z;
+                    }
+                    row0[j] -= p * x;
+                    row1[j] -= p * y;
+                }
+
+                int last = min_int(n, k + 3);
+                for (int i = 0; i <= last; i++) {
+                    double* row = &H_AT(ws, i, 0);
+                    p = x * row[k] + y * row[k + 1];
+                    if (notlast) {
+                        p += z * row[k + 2];
+                        row[k + 2] -= p * r;
+                    }
+                    row[k] -= p;
+                    row[k + 1] -= p * q;
+                }
+
+                double* v0 = &VT_AT(ws, k, 0);
+                double* v1 = &VT_AT(ws, k + 1, 0);
+                double* v2 = notlast ? &VT_AT(ws, k + 2, 0) : NULL;
+                for (int i = low; i <= high; i++) {
+                    p = x * v0[i] + y * v1[i];
+                    if (notlast) {
+                        p += z * v2[i];
+                        v2[i] -= p * r;
+                    }
+                    v0[i] -= p;
+                    v1[i] -= p * q;
+                }
+            }
+        }
+    }
+
+    return norm;
+}
+
+/* ---------------- Eigenvectors ---------------- */
+
+// Back-substitutes the eigenvectors of the quasi-triangular T = H into the
+// upper triangle of H, column by column.
+static void schur_back_substitute(eigen_workspace_t* ws, double norm) {
+    int nn = ws->n;
+    double eps = DBL_EPSILON;
+    double* d = ws->d;
+    double* e = ws->e;
+    double p, q, r = 0, s = 0, t, w, x, y, z = 0;
+
+    for (int n = nn - 1; n >= 0; n--) {
+        p = d[n];
+        q = e[n];
+
+        if (q == 0) {
+            // Real vector.
+            int l = n;
+            H_AT(ws, n, n) = 1.0;
+            for (int i = n - 1; i >= 0; i--) {
+                w = H_AT(ws, i, i) - p;
+                r = 0.0;
+                for (int j = l; j <= n; j++) {
+                    r += H_AT(ws, i, j) * H_AT(ws, j, n);
+                }
+                if (e[i] < 0.0) {
+                    z = w;
+                    s = r;
+                    continue;
+                }
+                l = i;
+                if (e[i] == 0.0) {
+                    H_AT(ws, i, n) = (w != 0.0) ? -r / w : -r / (eps * norm);
+                } else {
+                    x = H_AT(ws, i, i + 1);
+                    y = H_AT(ws, i + 1, i);
+                    q = (d[i] - p) * (d[i] - p) + e[i] * e[i];
+                    t = (x * s - z * r) / q;
+                    H_AT(ws, i, n) = t;
+                    if (fabs(x) > fabs(z)) {
+                        H_AT(ws, i + 1, n) = (-r - w * t) / x;
+                    } else {
+                        H_AT(ws, i + 1, n) = (-s - y * t) / z;
+                    }
+                }
+
+                t = fabs(H_AT(ws, i, n));
+                if ((eps * t) * t > 1) {
+                    for (int j = i; j <= n; j++) {
+                        H_AT(ws, j, n) /= t;
+                    }
+                }
+            }
+        } else if (q < 0) {
+            // Complex vector: real part in column n-1, imaginary part in n.
+            int l = n - 1;
+            if (fabs(H_AT(ws, n, n - 1)) > fabs(H_AT(ws, n - 1, n))) {
+                H_AT(ws, n - 1, n - 1) = q / H_AT(ws, n, n - 1);
+                H_AT(ws, n - 1, n) = -(H_AT(ws, n, n) - p) / H_AT(ws, n, n - 1);
+            } else {
+                complex_divide(0.0, -H_AT(ws, n - 1, n), H_AT(ws, n - 1, n - 1) - p, q,
+                               &H_AT(ws, n - 1, n - 1), &H_AT(ws, n - 1, n));
+            }
+            H_AT(ws, n, n - 1) = 0.0;
+            H_AT(ws, n, n) = 1.0;
+
+            for (int i = n - 2; i >= 0; i--) {
+                double ra = 0.0, sa = 0.0, vr, vi;
+                for (int j = l; j <= n; j++) {
+                    ra += H_AT(ws, i, j) * H_AT(ws, j, n - 1);
+                    sa += H_AT(ws, i, j) * H_AT(ws, j, n);
+                }
+                w = H_AT(ws, i, i) - p;
+
+                if (e[i] < 0.0) {
+                    z = w;
+                    r = ra;
+                    s = sa;
+                    continue;
+                }
+                l = i;
+                if (e[i] == 0) {
+                    complex_divide(-ra, -sa, w, q, &H_AT(ws, i, n - 1), &H_AT(ws, i, n));
+                } else {
+                    x = H_AT(ws, i, i + 1);
+                    y = H_AT(ws, i + 1, i);
+                    vr = (d[i] - p) * (d[i] - p) + e[i] * e[i] - q * q;
+                    vi = (d[i] - p) * 2.0 * q;
+                    if (vr == 0.0 && vi == 0.0) {
+                        vr = eps * norm * (fabs(w) + fabs(q) + fabs(x) + fabs(y) + fabs(z));
+                    }
+                    complex_divide(x * r - z * ra + q * sa, x * s - z * sa - q * ra, vr, vi,
+                                   &H_AT(ws, i, n - 1), &H_AT(ws, i, n));
+                    if (fabs(x) > (fabs(z) + fabs(q))) {
+                        H_AT(ws, i + 1, n - 1) = (-ra - w * H_AT(ws, i, n - 1) + q * H_AT(ws, i, n)) / x;
+                        H_AT(ws, i + 1, n) = (-sa - w * H_AT(ws, i, n) - q * H_AT(ws, i, n - 1)) / x;
+                    } else {
+                        complex_divide(-r - y * H_AT(ws, i, n - 1), -s - y * H_AT(ws, i, n), z, q,
+                                       &H_AT(ws, i + 1, n - 1), &H_AT(ws, i + 1, n));
+                    }
+                }
+
+                t = fmax(fabs(H_AT(ws, i, n - 1)), fabs(H_AT(ws, i, n)));
+                if ((eps * t) * t > 1) {
+                    for (int j = i; j <= n; j++) {
+                        H_AT(ws, j, n - 1) /= t;
+                        H_AT(ws, j, n) /= t;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static int compare_eigen(const void* a, const void* b) {
+    const eigen_t* x = (const eigen_t*)a;
+    const eigen_t* y = (const eigen_t*)b;
+    if (x->eigenvalue != y->eigenvalue) return x->eigenvalue < y->eigenvalue ? 1 : -1;
+    if (x->eigenvalue_imag != y->eigenvalue_imag) return x->eigenvalue_imag < y->eigenvalue_imag ? 1 : -1;
+    return 0;
+}
+
+// Builds the result array from the rows of Xt = (V * T-vectors)^T.
+static eigen_t* collect_eigenpairs(const eigen_workspace_t* ws, const double* Xt) {
+    int n = ws->n;
+    eigen_t* results = (eigen_t*)calloc((size_t)n, sizeof(eigen_t));
+    if (!results) return NULL;
+
+    for (int j = 0; j < n; j++) {
+        eigen_t* pair = &results[j];
+        pair->eigenvalue = ws->d[j];
+        pair->eigenvalue_imag = ws->e[j];
+        pair->eigenvector = (double*)malloc(n * sizeof(double));
+        if (!pair->eigenvector) goto fail;
+
+        if (ws->e[j] == 0.0) {
+            memcpy(pair->eigenvector, Xt + (size_t)j * ws->ld, n * sizeof(double));
+            vector_normalize(pair->eigenvector, n);
+            continue;
+        }
+
+        // The pair (j, j+1) or (j-1, j) shares real part row and imaginary
+        // part row; the conjugate flips the sign of the imaginary part.
+        int first = ws->e[j] > 0 ? j : j - 1;
+        double sign = ws->e[j] > 0 ? 1.0 : -1.0;
+        const double* re = Xt + (size_t)first * ws->ld;
+        const double* im = Xt + (size_t)(first + 1) * ws->ld;
+        pair->eigenvector_imag = (double*)malloc(n * sizeof(double));
+        if (!pair->eigenvector_imag) goto fail;
+
+        double norm = sqrt(vector_dot_product(re, re, n) + vector_dot_product(im, im, n));
+        if (norm < 1e-300) norm = 1.0;
+        for (int i = 0; i < n; i++) {
+            pair->eigenvector[i] = re[i] / norm;
+            pair->eigenvector_imag[i] = sign * im[i] / norm;
+        }
+    }
+
+    qsort(results, (size_t)n, sizeof(eigen_t), compare_eigen);
+    return results;
+
+fail:
+    for (int j = 0; j < n; j++) {
+        free(results[j].eigenvector);
+        free(results[j].eigenvector_imag);
+    }
+    free(results);
+    return NULL;
+}
+
+static int general_solve(const double* a, int n, int lda, eigen_t** eigenvalues, int* count) {
+    eigen_workspace_t ws;
+    ws.n = n;
+    ws.ld = matrix_stride_for(n);
+    ws.parallel = is_openmp_enabled();
+    ws.H = eigen_alloc((size_t)n * ws.ld);
+    ws.Vt = eigen_alloc((size_t)n * ws.ld);
+    ws.d = eigen_alloc((size_t)n);
+    ws.e = eigen_alloc((size_t)n);
+    double* Ut = eigen_alloc((size_t)n * ws.ld);
+    double* Xt = eigen_alloc((size_t)n * ws.ld);
+
+    int status = -1;
+    if (!ws.H || !ws.Vt || !ws.d || !ws.e || !Ut || !Xt) {
+        printf("Memory allocation failed for eigen solver workspace\n");
+        goto done;
+    }
+
+    for (int i = 0; i < n; i++) {
+        memcpy(&H_AT(&ws, i, 0), a + (size_t)i * lda, n * sizeof(double));
+    }
+
+    if (hessenberg_reduce(&ws) != 0) goto done;
+
+    double norm = schur_reduce(&ws);
+    if (norm < 0.0) {
+        printf("Warning: QR iteration did not converge for %dx%d matrix\n", n, n);
+        goto done;
+    }
+
+    if (norm > 0.0) {
+        schur_back_substitute(&ws, norm);
+    } else {
+        // Zero matrix: every vector is an eigenvector, keep the identity.
+        for (int i = 0; i < n; i++) {
+            H_AT(&ws, i, i) = 1.0;
+        }
+    }
+
+    // Eigenvectors of A are V * Y for the upper triangle Y now held in H.
+    // Row j of Xt = Y^T * V^T is eigenvector (column) j of that product.
+    for (int j = 0; j < n; j++) {
+        for (int k = 0; k <= j; k++) {
+            Ut[(size_t)j * ws.ld + k] = H_AT(&ws, k, j);
+        }
+    }
+    gemm_compute(n, n, n, 1.0, Ut, ws.ld, ws.Vt, ws.ld, Xt, ws.ld, ws.parallel);
+
+    *eigenvalues = collect_eigenpairs(&ws, Xt);
+    if (*eigenvalues) {
+        *count = n;
+        status = 0;
+    }
+
+done:
+    free(ws.H);
+    free(ws.Vt);
+    free(ws.d);
+    free(ws.e);
+    free(Ut);
+    free(Xt);
+    return status;
+}
+
+int eigen_solve_general(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
+    if (!matrix || matrix->rows != matrix->cols) return -1;
+    return general_solve(matrix->storage, matrix->rows, matrix->stride, eigenvalues, count);
+}
+
+/* ---------------- Symmetric solvers ---------------- */
+
+int eigen_matrix_is_symmetric(const matrix_t* matrix) {
+    if (!matrix || matrix->rows != matrix->cols) return 0;
+
+    for (int i = 0; i < matrix->rows; i++) {
+        for (int j = i + 1; j < matrix->cols; j++) {
+            double a = matrix->data[i][j];
+            double b = matrix->data[j][i];
+            if (fabs(a - b) > EIGEN_SYMMETRY_TOLERANCE * fmax(fabs(a), fabs(b))) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Allocates the workspace and loads (A + A^T) / 2 into H.
+static int symmetric_workspace_init(eigen_workspace_t* ws, const double* a, int n, int lda) {
+    ws->n = n;
+    ws->ld = matrix_stride_for(n);
+    ws->parallel = is_openmp_enabled();
+    ws->H = eigen_alloc((size_t)n * ws->ld);
+    ws->Vt = eigen_alloc((size_t)n * ws->ld);
+    ws->d = eigen_alloc((size_t)n);
+    ws->e = eigen_alloc((size_t)n);
+    if (!ws->H || !ws->Vt || !ws->d || !ws->e) {
+        printf("Memory allocation failed for eigen solver workspace\n");
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            H_AT(ws, i, j) = 0.5 * (a[(size_t)i * lda + j] + a[(size_t)j * lda + i]);
+        }
+    }
+    return 0;
+}
+
+static void workspace_free(eigen_workspace_t* ws) {
+    free(ws->H);
+    free(ws->Vt);
+    free(ws->d);
+    free(ws->e);
+}
+
+// Eigenvalues in d, eigenvectors in the rows of Vt; e is cleared so every
+// pair is collected as real.
+static int symmetric_collect(eigen_workspace_t* ws, eigen_t** eigenvalues, int* count) {
+    memset(ws->e, 0, ws->n * sizeof(double));
+    *eigenvalues = collect_eigenpairs(ws, ws->Vt);
+    if (!*eigenvalues) return -1;
+    *count = ws->n;
+    return 0;
+}
+
+// Householder reduction of the symmetric H to tridiagonal form (EISPACK
+// tred2). V is kept transposed in Vt, so every inner loop over a column of
+// V runs along a row of Vt.
+// Leaves the diagonal in d, the subdiagonal in e[1..n-1] and the
+// accumulated transformation in Vt.
+static void tridiagonal_reduce(eigen_workspace_t* ws) {
+    int n = ws->n;
+    double* d = ws->d;
+    double* e = ws->e;
+
+    // V starts as A; A is symmetric, so Vt = A as well.
+    for (int i = 0; i < n; i++) {
+        memcpy(&VT_AT(ws, i, 0), &H_AT(ws, i, 0), n * sizeof(double));
+    }
+    #define V_AT(row, col) VT_AT(ws, col, row)
+
+    for (int j = 0; j < n; j++) {
+        d[j] = V_AT(n - 1, j);
+    }
+
+    for (int i = n - 1; i > 0; i--) {
+        double scale = 0.0;
+        double h = 0.0;
+        for (int k = 0; k < i; k++) {
+            scale += fabs(d[k]);
+        }
+
+        if (scale == 0.0) {
+            e[i] = d[i - 1];
+            for (int j = 0; j < i; j++) {
+                d[j] = V_AT(i - 1, j);
+                V_AT(i, j) = 0.0;
+                V_AT(j, i) = 0.0;
+            }
+        } else {
+            for (int k = 0; k < i; k++) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            double f = d[i - 1];
+            double g = sqrt(h);
+            if (f > 0) g = -g;
+            e[i] = scale * g;
+            h -= f * g;
+            d[i - 1] = f - g;
+            memset(e, 0, i * sizeof(double));
+
+            for (int j = 0; j < i; j++) {
+                const double* column = &VT_AT(ws, j, 0);
+                f = d[j];
+                V_AT(j, i) = f;
+                g = e[j] + column[j] * f;
+                for (int k = j + 1; k <= i - 1; k++) {
+                    g += column[k] * d[k];
+                    e[k] += column[k] * f;
+                }
+                e[j] = g;
+            }
+
+            f = 0.0;
+            for (int j = 0; j < i; j++) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            double hh = f / (h + h);
+            for (int j = 0; j < i; j++) {
+                e[j] -= hh * d[j];
+            }
+
+            // Rank-2 update of the leading block; columns are independent.
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic, 16) if(ws->parallel && i >= EIGEN_PARALLEL_MIN_ROWS)
+            #endif
+            for (int j = 0; j < i; j++) {
+                double* column = &VT_AT(ws, j, 0);
+                double fj = d[j];
+                double gj = e[j];
+                simd_kernels.vector_axpy(-fj, e + j, column + j, i - j);
+                simd_kernels.vector_axpy(-gj, d + j, column + j, i - j);
+            }
+            for (int j = 0; j < i; j++) {
+                d[j] = V_AT(i - 1, j);
+                V_AT(i, j) = 0.0;
+            }
+        }
+        d[i] = h;
+    }
+
+    // Accumulate the transformations.
+    for (int i = 0; i < n - 1; i++) {
+        V_AT(n - 1, i) = V_AT(i, i);
+        V_AT(i, i) = 1.0;
+        double h = d[i + 1];
+        if (h != 0.0) {
+            const double* reflector = &VT_AT(ws, i + 1, 0);
+            for (int k = 0; k <= i; k++) {
+                d[k] = reflector[k] / h;
+            }
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(static) if(ws->parallel && i >= EIGEN_PARALLEL_MIN_ROWS)
+            #endif
+            for (int j = 0; j <= i; j++) {
+                double* column = &VT_AT(ws, j, 0);
+                double g = simd_kernels.vector_dot(reflector, column, i + 1);
+                simd_kernels.vector_axpy(-g, d, column, i + 1);
+            }
+        }
+        memset(&VT_AT(ws, i + 1, 0), 0, (i + 1) * sizeof(double));
+    }
+    for (int j = 0; j < n; j++) {
+        d[j] = V_AT(n - 1, j);
+        V_AT(n - 1, j) = 0.0;
+    }
+    V_AT(n - 1, n - 1) = 1.0;
+    e[0] = 0.0;
+
+    #undef V_AT
+}
+
+// Implicit QL on the tridiagonal (d, e) left by tridiagonal_reduce (EISPACK
+// tql2), rotating the rows of Vt along. Returns -1 when a value does not
+// converge within EIGEN_QL_STEPS_PER_VALUE steps.
+static int tridiagonal_ql(eigen_workspace_t* ws) {
+    int n = ws->n;
+    double* d = ws->d;
+    double* e = ws->e;
+    double eps = DBL_EPSILON;
+
+    for (int i = 1; i < n; i++) {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0.0;
+
+    double f = 0.0;
+    double tst1 = 0.0;
+    for (int l = 0; l < n; l++) {
+        tst1 = fmax(tst1, fabs(d[l]) + fabs(e[l]));
+        int m = l;
+        while (m < n - 1) {
+            if (fabs(e[m]) <= eps * tst1) break;
+            m++;
+        }
+
+        if (m > l) {
+            int iter = 0;
+            do {
+                if (++iter > EIGEN_QL_STEPS_PER_VALUE) return -1;
+
+                double g = d[l];
+                double p = (d[l + 1] - g) / (2.0 * e[l]);
+                double r = hypot(p, 1.0);
+                if (p < 0) r = -r;
+                d[l] = e[l] / (p + r);
+                d[l + 1] = e[l] * (p + r);
+                double dl1 = d[l + 1];
+                double h = g - d[l];
+                for (int i = l + 2; i < n; i++) {
+                    d[i] -= h;
+                }
+                f += h;
+
+                p = d[m];
+                double c = 1.0, c2 = c, c3 = c;
+                double el1 = e[l + 1];
+                double s = 0.0, s2 = 0.0;
+                for (int i = m - 1; i >= l; i--) {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[i];
+                    h = c * p;
+                    r = hypot(p, e[i]);
+                    e[i + 1] = s * r;
+                    s = e[i] / r;
+                    c = p / r;
+                    p = c * d[i] - s * g;
+                    d[i + 1] = h + s * (c * g + s * d[i]);
+
+                    double* v0 = &VT_AT(ws, i, 0);
+                    double* v1 = &VT_AT(ws, i + 1, 0);
+                    for (int k = 0; k < n; k++) {
+                        double t = v1[k];
+                        v1[k] = s * v0[k] + c * t;
+                        v0[k] = c * v0[k] - s * t;
+                    }
+                }
+                p = -s * s2 * c3 * el1 * e[l] / dl1;
+                e[l] = s * p;
+                d[l] = c * p;
+            } while (fabs(e[l]) > eps * tst1);
+        }
+        d[l] += f;
+        e[l] = 0.0;
+    }
+    return 0;
+}
+
+static int symmetric_ql_solve(const double* a, int n, int lda, eigen_t** eigenvalues, int* count) {
+    eigen_workspace_t ws;
+    int status = -1;
+    if (symmetric_workspace_init(&ws, a, n, lda) == 0) {
+        tridiagonal_reduce(&ws);
+        if (tridiagonal_ql(&ws) != 0) {
+            printf("Warning: QL iteration did not converge for %dx%d matrix\n", ws.n, ws.n);
+        } else {
+            status = symmetric_collect(&ws, eigenvalues, count);
+        }
+    }
+    workspace_free(&ws);
+    return status;
+}
+
+int eigen_solve_symmetric_ql(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
+    if (!matrix || matrix->rows != matrix->cols) return -1;
+    return symmetric_ql_solve(matrix->storage, matrix->rows, matrix->stride, eigenvalues, count);
+}
+
+int eigen_solve_dense(const double* a, int n, int lda, int symmetric,
+                      eigen_t** eigenvalues, int* count) {
+    if (!a || n <= 0) return -1;
+    if (symmetric) return symmetric_ql_solve(a, n, lda, eigenvalues, count);
+    return general_solve(a, n, lda, eigenvalues, count);
+}
+
+static double off_diagonal_norm(const eigen_workspace_t* ws) {
+    double sum = 0.0;
+    for (int i = 0; i < ws->n; i++) {
+        const double* row = &ws->H[(size_t)i * ws->ld];
+        for (int j = 0; j < ws->n; j++) {
+            if (j != i) sum += row[j] * row[j];
+        }
+    }
+    return sqrt(sum);
+}
+
+// Rotation (c, s) that annihilates H[p][q] in J^T H J (Rutishauser's form).
+static void jacobi_rotation(const eigen_workspace_t* ws, int p, int q, double* c, double* s) {
+    double apq = H_AT(ws, p, q);
+    if (fabs(apq) < DBL_MIN) {
+        *c = 1.0;
+        *s = 0.0;
+        return;
+    }
+    double theta = (H_AT(ws, q, q) - H_AT(ws, p, p)) / (2.0 * apq);
+    double t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+    if (theta < 0) t = -t;
+    *c = 1.0 / sqrt(t * t + 1.0);
+    *s = t * *c;
+}
+
+static void rotate_rows(double* row_p, double* row_q, int n, double c, double s) {
+    for (int k = 0; k < n; k++) {
+        double a = row_p[k];
+        double b = row_q[k];
+        row_p[k] = c * a - s * b;
+        row_q[k] = s * a + c * b;
+    }
+}
+
+int eigen_solve_symmetric_jacobi(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
+    if (!matrix || matrix->rows != matrix->cols) return -1;
+
+    eigen_workspace_t ws;
+    int status = -1;
+    int n = matrix->rows;
+    // Round-robin tournament over an even number of players; with odd n the
+    // extra player n is a bye.
+    int players = n + (n & 1);
+    int pairs = players / 2;
+    int* order = (int*)malloc(players * sizeof(int));
+    int* pair_p = (int*)malloc(pairs * sizeof(int));
+    int* pair_q = (int*)malloc(pairs * sizeof(int));
+    double* rot_c = (double*)malloc(pairs * sizeof(double));
+    double* rot_s = (double*)malloc(pairs * sizeof(double));
+
+    if (symmetric_workspace_init(&ws, matrix->storage, n, matrix->stride) != 0 || !order || !pair_p || !pair_q || !rot_c || !rot_s) {
+        goto done;
+    }
+
+    for (int i = 0; i < n; i++) {
+        VT_AT(&ws, i, i) = 1.0;
+    }
+    for (int i = 0; i < players; i++) {
+        order[i] = i;
+    }
+
+    double norm = 0.0;
+    for (int i = 0; i < n; i++) {
+        norm += simd_kernels.vector_dot(&H_AT(&ws, i, 0), &H_AT(&ws, i, 0), n);
+    }
+    norm = sqrt(norm);
+    double target = global_config.eigen_tolerance * norm;
+
+    int converged = (off_diagonal_norm(&ws) <= target);
+    for (int sweep = 0; sweep < EIGEN_JACOBI_MAX_SWEEPS && !converged; sweep++) {
+        for (int round = 0; round < players - 1; round++) {
+            int active = 0;
+            for (int k = 0; k < pairs; k++) {
+                int p = order[k];
+                int q = order[players - 1 - k];
+                if (p == n || q == n) continue;
+                pair_p[active] = p < q ? p : q;
+                pair_q[active] = p < q ? q : p;
+                active++;
+            }
+
+            // The rotations of one round touch disjoint index pairs, so
+            // J = J_1 ... J_active is applied as one row pass and one
+            // column pass, each split over threads.
+            #ifdef _OPENMP
+            #pragma omp parallel if(ws.parallel && n >= EIGEN_PARALLEL_MIN_ROWS)
+            #endif
+            {
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (int k = 0; k < active; k++) {
+                    jacobi_rotation(&ws, pair_p[k], pair_q[k], &rot_c[k], &rot_s[k]);
+                }
+
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (int k = 0; k < active; k++) {
+                    if (rot_s[k] == 0.0) continue;
+                    rotate_rows(&H_AT(&ws, pair_p[k], 0), &H_AT(&ws, pair_q[k], 0), n, rot_c[k], rot_s[k]);
+                    rotate_rows(&VT_AT(&ws, pair_p[k], 0), &VT_AT(&ws, pair_q[k], 0), n, rot_c[k], rot_s[k]);
+                }
+
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (int i = 0; i < n; i++) {
+                    double* row = &H_AT(&ws, i, 0);
+                    for (int k = 0; k < active; k++) {
+                        int p = pair_p[k];
+                        int q = pair_q[k];
+                        double c = rot_c[k];
+                        double s = rot_s[k];
+                        if (s == 0.0) continue;
+                        double a = row[p];
+                        double b = row[q];
+                        row[p] = c * a - s * b;
+                        row[q] = s * a + c * b;
+                    }
+                }
+
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (int k = 0; k < active; k++) {
+                    if (rot_s[k] == 0.0) continue;
+                    H_AT(&ws, pair_p[k], pair_q[k]) = 0.0;
+                    H_AT(&ws, pair_q[k], pair_p[k]) = 0.0;
+                }
+            }
+
+            // Keep player 0 fixed and rotate the others one seat.
+            int last = order[players - 1];
+            memmove(order + 2, order + 1, (players - 2) * sizeof(int));
+            order[1] = last;
+        }
+        converged = (off_diagonal_norm(&ws) <= target);
+    }
+
+    if (!converged) {
+        printf("Warning: Jacobi did not converge after %d sweeps\n", EIGEN_JACOBI_MAX_SWEEPS);
+        goto done;
+    }
+
+    for (int i = 0; i < n; i++) {
+        ws.d[i] = H_AT(&ws, i, i);
+    }
+    status = symmetric_collect(&ws, eigenvalues, count);
+
+done:
+    workspace_free(&ws);
+    free(order);
+    free(pair_p);
+    free(pair_q);
+    free(rot_c);
+    free(rot_s);
+    return status;
+}
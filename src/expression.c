@@ -0,0 +1,431 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/expression.h"
+#include "../include/dispatcher.h"
+#include "../include/simd_kernels.h"
+#include "../include/openmp_utils.h"
+
+// One fused element-wise operation: reads slots x and y, writes slot out.
+typedef struct {
+    expr_op_t op;
+    int x;
+    int y;
+    int out;
+    double scalar;
+} expr_step_t;
+
+// A fused chain in evaluation order. Leaf slots point into the rows of
+// materialized matrices; step k writes its block into scratch block k,
+// except the last step, which writes the result row directly.
+typedef struct {
+    int slots;
+    int leaf_count;
+    int leaf_slot[EXPR_MAX_NODES];
+    const matrix_t* leaf[EXPR_MAX_NODES];
+    int steps;
+    expr_step_t step[EXPR_MAX_NODES];
+} expr_program_t;
+
+static matrix_t* fuse(expr_graph_t* graph, const expr_t* root, const char* name);
+
+expr_graph_t* expr_graph_create(void) {
+    return (expr_graph_t*)calloc(1, sizeof(expr_graph_t));
+}
+
+void expr_graph_free(expr_graph_t* graph) {
+    if (!graph) return;
+    for (int i = 0; i < graph->count; i++) {
+        free_matrix(graph->nodes[i].value);
+    }
+    free(graph);
+}
+
+// Returns the existing node when an identical one was already built, so a
+// repeated sub-expression becomes one shared node of the DAG.
+static expr_t* add_node(expr_graph_t* graph, expr_op_t op, int rows, int cols,
+                        const expr_t* a, const expr_t* b, double scalar, const matrix_t* input) {
+    if ((op == EXPR_ADD || op == EXPR_HADAMARD) && a > b) {
+        const expr_t* swap = a;
+        a = b;
+        b = swap;
+    }
+    for (int i = 0; i < graph->count; i++) {
+        expr_t* node = &graph->nodes[i];
+        if (node->op == op && node->a == a && node->b == b && node->scalar == scalar && node->input == input) {
+            return node;
+        }
+    }
+    if (graph->count == EXPR_MAX_NODES) {
+        printf("Expression has more than %d nodes\n", EXPR_MAX_NODES);
+        return NULL;
+    }
+
+    expr_t* node = &graph->nodes[graph->count++];
+    memset(node, 0, sizeof(*node));
+    node->op = op;
+    node->rows = rows;
+    node->cols = cols;
+    node->a = a;
+    node->b = b;
+    node->scalar = scalar;
+    node->input = input;
+    return node;
+}
+
+expr_t* expr_input(expr_graph_t* graph, const matrix_t* matrix) {
+    if (!graph || !matrix) return NULL;
+    return add_node(graph, EXPR_INPUT, matrix->rows, matrix->cols, NULL, NULL, 0.0, matrix);
+}
+
+static expr_t* elementwise(expr_graph_t* graph, expr_op_t op, const expr_t* a, const expr_t* b,
+                           const char* what) {
+    if (!graph || !a || !b) return NULL;
+    if (a->rows != b->rows || a->cols != b->cols) {
+        printf("Matrix dimensions don't match for %s (%dx%d and %dx%d)\n",
+               what, a->rows, a->cols, b->rows, b->cols);
+        return NULL;
+    }
+    return add_node(graph, op, a->rows, a->cols, a, b, 0.0, NULL);
+}
+
+expr_t* expr_add(expr_graph_t* graph, const expr_t* a, const expr_t* b) {
+    return elementwise(graph, EXPR_ADD, a, b, "addition");
+}
+
+expr_t* expr_subtract(expr_graph_t* graph, const expr_t* a, const expr_t* b) {
+    return elementwise(graph, EXPR_SUBTRACT, a, b, "subtraction");
+}
+
+expr_t* expr_hadamard(expr_graph_t* graph, const expr_t* a, const expr_t* b) {
+    return elementwise(graph, EXPR_HADAMARD, a, b, "element-wise product");
+}
+
+expr_t* expr_scale(expr_graph_t* graph, double scalar, const expr_t* a) {
+    if (!graph || !a) return NULL;
+    // Nested scalings fold into one.
+    while (a->op == EXPR_SCALE) {
+        scalar *= a->scalar;
+        a = a->a;
+    }
+    if (scalar == 1.0) return &graph->nodes[a - graph->nodes];
+    return add_node(graph, EXPR_SCALE, a->rows, a->cols, a, NULL, scalar, NULL);
+}
+
+expr_t* expr_multiply(expr_graph_t* graph, const expr_t* a, const expr_t* b) {
+    if (!graph || !a || !b) return NULL;
+    if (a->cols != b->rows) {
+        printf("Matrix dimensions don't match for multiplication (%dx%d and %dx%d)\n",
+               a->rows, a->cols, b->rows, b->cols);
+        return NULL;
+    }
+    return add_node(graph, EXPR_MULTIPLY, a->rows, b->cols, a, b, 0.0, NULL);
+}
+
+// The value of a node as a matrix: inputs as they are, anything else
+// computed once and kept in the graph.
+static const matrix_t* materialize(expr_graph_t* graph, const expr_t* node) {
+    if (node->op == EXPR_INPUT) return node->input;
+    expr_t* owned = &graph->nodes[node - graph->nodes];
+    if (owned->value) return owned->value;
+
+    if (node->op == EXPR_MULTIPLY) {
+        const matrix_t* A = materialize(graph, node->a);
+        const matrix_t* B = A ? materialize(graph, node->b) : NULL;
+        engine_t used;
+        owned->value = B ? dispatch_binary(DISPATCH_MULTIPLY, ENGINE_AUTO, A, B, &used) : NULL;
+    } else {
+        owned->value = fuse(graph, node, "expression");
+    }
+    return owned->value;
+}
+
+// Appends node and its element-wise operands to the program, stopping at
+// anything that has to be a matrix. Each node gets one slot however many
+// times it is reached. Returns the node's slot, or -1 on failure.
+static int compile(expr_graph_t* graph, const expr_t* node, expr_program_t* program, int* slot_of) {
+    int index = (int)(node - graph->nodes);
+    if (slot_of[index] >= 0) return slot_of[index];
+
+    int slot;
+    if (node->op == EXPR_INPUT || node->op == EXPR_MULTIPLY || node->value) {
+        const matrix_t* matrix = materialize(graph, node);
+        if (!matrix) return -1;
+        slot = program->slots++;
+        program->leaf_slot[program->leaf_count] = slot;
+        program->leaf[program->leaf_count++] = matrix;
+    } else {
+        int x = compile(graph, node->a, program, slot_of);
+        int y = node->b ? compile(graph, node->b, program, slot_of) : x;
+        if (x < 0 || y < 0) return -1;
+        slot = program->slots++;
+        expr_step_t* step = &program->step[program->steps++];
+        step->op = node->op;
+        step->x = x;
+        step->y = y;
+        step->out = slot;
+        step->scalar = node->scalar;
+    }
+    slot_of[index] = slot;
+    return slot;
+}
+
+static void apply_step(const expr_step_t* step, const double* x, const double* y, double* out, int n) {
+    switch (step->op) {
+        case EXPR_ADD:
+            simd_kernels.vector_add(x, y, out, n);
+            break;
+        case EXPR_SUBTRACT:
+            simd_kernels.vector_sub(x, y, out, n);
+            break;
+        case EXPR_HADAMARD:
+            for (int j = 0; j < n; j++) out[j] = x[j] * y[j];
+            break;
+        case EXPR_SCALE:
+            for (int j = 0; j < n; j++) out[j] = step->scalar * x[j];
+            break;
+        default:
+            break;
+    }
+}
+
+static int run_program(const expr_program_t* program, matrix_t* result) {
+    int rows = result->rows;
+    int cols = result->cols;
+    int threads = 1;
+    #ifdef _OPENMP
+    int parallel = is_openmp_enabled() && (long)rows * cols >= EXPR_PARALLEL_MIN_ELEMENTS;
+    if (parallel) threads = omp_get_max_threads();
+    #endif
+
+    size_t per_thread = (size_t)(program->steps > 1 ? program->steps - 1 : 1) * EXPR_BLOCK;
+    double* scratch = NULL;
+    if (posix_memalign((void**)&scratch, MATRIX_ALIGNMENT, (size_t)threads * per_thread * sizeof(double)) != 0) {
+        printf("Memory allocation failed for expression scratch\n");
+        return -1;
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(threads) if(parallel)
+    #endif
+    {
+        int thread = 0;
+        #ifdef _OPENMP
+        thread = omp_get_thread_num();
+        #endif
+        double* blocks = scratch + (size_t)thread * per_thread;
+        const double* slot[EXPR_MAX_NODES];
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int i = 0; i < rows; i++) {
+            for (int j0 = 0; j0 < cols; j0 += EXPR_BLOCK) {
+                int n = cols - j0 < EXPR_BLOCK ? cols - j0 : EXPR_BLOCK;
+                for (int l = 0; l < program->leaf_count; l++) {
+                    slot[program->leaf_slot[l]] = MATRIX_ROW(program->leaf[l], i) + j0;
+                }
+                for (int k = 0; k < program->steps; k++) {
+                    const expr_step_t* step = &program->step[k];
+                    double* out = k == program->steps - 1 ? MATRIX_ROW(result, i) + j0
+                                                          : blocks + (size_t)k * EXPR_BLOCK;
+                    apply_step(step, slot[step->x], slot[step->y], out, n);
+                    slot[step->out] = out;
+                }
+            }
+        }
+    }
+
+    free(scratch);
+    return 0;
+}
+
+// Evaluates an element-wise root in one pass over its rows.
+static matrix_t* fuse(expr_graph_t* graph, const expr_t* root, const char* name) {
+    expr_program_t program;
+    int slot_of[EXPR_MAX_NODES];
+    program.slots = 0;
+    program.leaf_count = 0;
+    program.steps = 0;
+    for (int i = 0; i < EXPR_MAX_NODES; i++) slot_of[i] = -1;
+    if (compile(graph, root, &program, slot_of) < 0) return NULL;
+
+    matrix_t* result = create_matrix(root->rows, root->cols, name);
+    if (!result) return NULL;
+    if (run_program(&program, result) != 0) {
+        free_matrix(result);
+        return NULL;
+    }
+    return result;
+}
+
+matrix_t* expr_evaluate(expr_graph_t* graph, const expr_t* root, const char* name) {
+    if (!graph || !root) return NULL;
+
+    matrix_t* result;
+    if (root->op == EXPR_INPUT) {
+        result = copy_matrix(root->input);
+    } else if (root->op == EXPR_MULTIPLY || root->value) {
+        // Hand the materialized value over instead of copying it.
+        if (!materialize(graph, root)) return NULL;
+        expr_t* owned = &graph->nodes[root - graph->nodes];
+        result = owned->value;
+        owned->value = NULL;
+    } else {
+        return fuse(graph, root, name);
+    }
+    if (result) snprintf(result->name, sizeof(result->name), "%s", name);
+    return result;
+}
+
+// Recursive descent over the grammar
+//   sum     := product (('+' | '-') product)*
+//   product := unary (('*' | '@') unary)*
+//   unary   := '-' unary | primary
+//   primary := NUMBER | NAME | '(' sum ')'
+// A term is either a matrix expression or a plain number.
+typedef struct {
+    const expr_t* node;   // NULL for a number
+    double number;
+} expr_term_t;
+
+typedef struct {
+    expr_graph_t* graph;
+    const char* p;
+    char* error;
+    size_t error_size;
+} expr_parser_t;
+
+static int parse_sum(expr_parser_t* parser, expr_term_t* term);
+
+static int parse_failed(expr_parser_t* parser, const char* message, const char* detail) {
+    snprintf(parser->error, parser->error_size, "%s%s", message, detail ? detail : "");
+    return -1;
+}
+
+static char peek(expr_parser_t* parser) {
+    while (isspace((unsigned char)*parser->p)) parser->p++;
+    return *parser->p;
+}
+
+static int parse_primary(expr_parser_t* parser, expr_term_t* term) {
+    char c = peek(parser);
+    if (c == '(') {
+        parser->p++;
+        if (parse_sum(parser, term) != 0) return -1;
+        if (peek(parser) != ')') return parse_failed(parser, "missing ')'", NULL);
+        parser->p++;
+        return 0;
+    }
+    if (isdigit((unsigned char)c) || c == '.') {
+        char* end;
+        term->node = NULL;
+        term->number = strtod(parser->p, &end);
+        if (end == parser->p) return parse_failed(parser, "bad number at: ", parser->p);
+        parser->p = end;
+        return 0;
+    }
+    if (isalpha((unsigned char)c) || c == '_') {
+        char name[sizeof(((matrix_t*)0)->name)];
+        size_t length = 0;
+        while (isalnum((unsigned char)*parser->p) || *parser->p == '_') {
+            if (length + 1 < sizeof(name)) name[length++] = *parser->p;
+            parser->p++;
+        }
+        name[length] = '\0';
+        const matrix_t* matrix = find_matrix_by_name(name);
+        if (!matrix) return parse_failed(parser, "no matrix named ", name);
+        term->node = expr_input(parser->graph, matrix);
+        return term->node ? 0 : parse_failed(parser, "expression too large", NULL);
+    }
+    return parse_failed(parser, c ? "unexpected input at: " : "unexpected end of expression", c ? parser->p : NULL);
+}
+
+static int parse_unary(expr_parser_t* parser, expr_term_t* term) {
+    if (peek(parser) != '-') return parse_primary(parser, term);
+    parser->p++;
+    if (parse_unary(parser, term) != 0) return -1;
+    if (term->node) {
+        term->node = expr_scale(parser->graph, -1.0, term->node);
+        if (!term->node) return parse_failed(parser, "expression too large", NULL);
+    } else {
+        term->number = -term->number;
+    }
+    return 0;
+}
+
+// Applies a binary operator; numbers fold, number * matrix scales.
+static int combine(expr_parser_t* parser, char op, expr_term_t* left, const expr_term_t* right) {
+    expr_graph_t* graph = parser->graph;
+    if (!left->node && !right->node) {
+        if (op == '@') return parse_failed(parser, "'@' needs two matrices", NULL);
+        left->number = op == '+' ? left->number + right->number
+                     : op == '-' ? left->number - right->number
+                                 : left->number * right->number;
+        return 0;
+    }
+    if (op == '*' && (!left->node || !right->node)) {
+        left->node = left->node ? expr_scale(graph, right->number, left->node)
+                                : expr_scale(graph, left->number, right->node);
+    } else if (!left->node || !right->node) {
+        char operator_text[2] = { op, '\0' };
+        return parse_failed(parser, "a number and a matrix cannot be combined with ", operator_text);
+    } else if (op == '+') {
+        left->node = expr_add(graph, left->node, right->node);
+    } else if (op == '-') {
+        left->node = expr_subtract(graph, left->node, right->node);
+    } else if (op == '*') {
+        left->node = expr_hadamard(graph, left->node, right->node);
+    } else {
+        left->node = expr_multiply(graph, left->node, right->node);
+    }
+    if (!left->node) {
+        char operator_text[2] = { op, '\0' };
+        return parse_failed(parser, "invalid operands for ", operator_text);
+    }
+    return 0;
+}
+
+static int parse_product(expr_parser_t* parser, expr_term_t* term) {
+    if (parse_unary(parser, term) != 0) return -1;
+    while (peek(parser) == '*' || peek(parser) == '@') {
+        char op = *parser->p++;
+        expr_term_t right;
+        if (parse_unary(parser, &right) != 0 || combine(parser, op, term, &right) != 0) return -1;
+    }
+    return 0;
+}
+
+static int parse_sum(expr_parser_t* parser, expr_term_t* term) {
+    if (parse_product(parser, term) != 0) return -1;
+    while (peek(parser) == '+' || peek(parser) == '-') {
+        char op = *parser->p++;
+        expr_term_t right;
+        if (parse_product(parser, &right) != 0 || combine(parser, op, term, &right) != 0) return -1;
+    }
+    return 0;
+}
+
+expr_t* expr_parse(expr_graph_t* graph, const char* text, char* error, size_t error_size) {
+    expr_parser_t parser = { graph, text, error, error_size };
+    expr_term_t term;
+    if (!graph || !text) {
+        parse_failed(&parser, "no expression", NULL);
+        return NULL;
+    }
+    if (parse_sum(&parser, &term) != 0) return NULL;
+    if (peek(&parser) != '\0') {
+        parse_failed(&parser, "unexpected input at: ", parser.p);
+        return NULL;
+    }
+    if (!term.node) {
+        parse_failed(&parser, "expression has no matrix", NULL);
+        return NULL;
+    }
+    return &graph->nodes[term.node - graph->nodes];
+}
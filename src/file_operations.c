@@ -1,56 +1,214 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "../include/file_operations.h"
 #include "../include/config.h"
+#include "../include/float_format.h"
+#include "../include/trace.h"
 
-int parse_matrix_line(const char* line, double* values, int max_values) {
-    char buffer[512];
-    strncpy(buffer, line, sizeof(buffer) - 1);
-    buffer[sizeof(buffer) - 1] = '\0';
-    
-    char* token = strtok(buffer, " \t\n,;[](){}");
-    int count = 0;
-    
-    while (token && count < max_values) {
-        if (strlen(token) == 1 && 
-            (token[0] == '[' || token[0] == ']' || token[0] == '(' || token[0] == ')' || 
-             token[0] == '{' || token[0] == '}' || token[0] == ',' || token[0] == ';')) {
-            token = strtok(NULL, " \t\n,;[](){}");
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Decimal to double. When the significant digits fit in 53 bits and the
+// decimal exponent is within +-22, both operands are exact and one IEEE
+// multiply or divide rounds correctly (Clinger's fast path). Everything
+// else (long mantissas, large exponents, hex, inf, nan) goes to strtod.
+// Returns the end of the parsed number, or p when there is none.
+static const char* parse_double(const char* p, double* value) {
+    const char* start = p;
+    int negative = 0;
+    if (*p == '-' || *p == '+') negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int seen = 0;
+    int dropped = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        seen = 1;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++;
+            dropped = 1;
+        }
+    }
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            seen = 1;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) digits++;
+                exponent--;
+            } else {
+                dropped = 1;
+            }
+        }
+    }
+    if (!seen) {
+        char* end;
+        *value = strtod(start, &end);
+        return end;
+    }
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        int exponent_negative = 0;
+        if (*q == '-' || *q == '+') exponent_negative = *q++ == '-';
+        if (*q >= '0' && *q <= '9') {
+            int written = 0;
+            for (; *q >= '0' && *q <= '9'; q++) {
+                if (written < 100000) written = written * 10 + (*q - '0');
+            }
+            exponent += exponent_negative ? -written : written;
+            p = q;
+        }
+    }
+
+    if (!dropped && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double result = (double)mantissa;
+        result = exponent < 0 ? result / exact_powers_of_ten[-exponent]
+                              : result * exact_powers_of_ten[exponent];
+        *value = negative ? -result : result;
+        return p;
+    }
+
+    char* end;
+    *value = strtod(start, &end);
+    return end;
+}
+
+static int is_separator(char c) {
+    switch (c) {
+        case ' ': case '\t': case '\r': case '\0':
+        case ',': case ';':
+        case '[': case ']': case '(': case ')': case '{': case '}':
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Buffered reader over a text file. The buffer always holds a NUL after the
+// valid bytes, and refills keep at least TEXT_MAX_TOKEN unread bytes in it
+// until the file ends, so a number never straddles a refill.
+typedef struct {
+    FILE* file;
+    char* buffer;
+    size_t length;
+    size_t position;
+    int eof;
+} text_stream_t;
+
+static void stream_fill(text_stream_t* stream) {
+    if (stream->eof || stream->length - stream->position >= TEXT_MAX_TOKEN) return;
+
+    size_t rest = stream->length - stream->position;
+    memmove(stream->buffer, stream->buffer + stream->position, rest);
+    stream->length = rest;
+    stream->position = 0;
+    while (!stream->eof && stream->length < TEXT_READ_CHUNK) {
+        size_t got = fread(stream->buffer + stream->length, 1, TEXT_READ_CHUNK - stream->length, stream->file);
+        if (got == 0) stream->eof = 1;
+        stream->length += got;
+    }
+    stream->buffer[stream->length] = '\0';
+}
+
+typedef struct {
+    double* values;
+    int count;
+    int capacity;
+} value_list_t;
+
+static int value_list_push(value_list_t* list, double value) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        double* values = (double*)realloc(list->values, (size_t)capacity * sizeof(double));
+        if (!values) return -1;
+        list->values = values;
+        list->capacity = capacity;
+    }
+    list->values[list->count++] = value;
+    return 0;
+}
+
+// Reads one line into row. Comment lines (leading '#') yield no values;
+// their first comment_size - 1 characters are copied to comment. Returns
+// the number of values, -1 at end of file, or -2 if memory runs out.
+static int stream_next_row(text_stream_t* stream, value_list_t* row, char* comment, size_t comment_size) {
+    row->count = 0;
+    comment[0] = '\0';
+    stream_fill(stream);
+    if (stream->position >= stream->length) return -1;
+
+    if (stream->buffer[stream->position] == '#') {
+        size_t used = 0;
+        for (;;) {
+            stream_fill(stream);
+            if (stream->position >= stream->length) break;
+            char c = stream->buffer[stream->position++];
+            if (c == '\n') break;
+            if (used + 1 < comment_size) comment[used++] = c;
+        }
+        comment[used] = '\0';
+        return 0;
+    }
+
+    for (;;) {
+        stream_fill(stream);
+        char* p = stream->buffer + stream->position;
+        char* end = stream->buffer + stream->length;
+        while (p < end && is_separator(*p)) p++;
+        if (p == end) {
+            stream->position = stream->length;
+            if (stream->eof) break;
             continue;
         }
-        
-        char* endptr;
-        double value = strtod(token, &endptr);
-        
-        if (endptr != token) {
-            values[count++] = value;
-        } else {
-            char cleaned_token[100];
-            strncpy(cleaned_token, token, sizeof(cleaned_token) - 1);
-            cleaned_token[sizeof(cleaned_token) - 1] = '\0';
-            
-            char* start = cleaned_token;
-            char* end = start + strlen(cleaned_token) - 1;
-            
-            while (start <= end && strchr("[](){};, \t", *start)) start++;
-            while (end > start && strchr("[](){};, \t", *end)) *end-- = '\0';
-            
-            if (start < end) {
-                value = strtod(start, &endptr);
-                if (endptr != start) {
-                    values[count++] = value;
-                }
+        if (*p == '\n') {
+            stream->position = (size_t)(p - stream->buffer) + 1;
+            break;
+        }
+
+        stream->position = (size_t)(p - stream->buffer);
+        stream_fill(stream);
+        p = stream->buffer + stream->position;
+        end = stream->buffer + stream->length;
+
+        char* token_end = p;
+        while (token_end < end && *token_end != '\n' && !is_separator(*token_end)) token_end++;
+
+        // Tokens such as "1.5abc" contribute their numeric prefix, as strtod
+        // would; forms the fast parser stops early on (hex) go to strtod.
+        double value;
+        const char* parsed = parse_double(p, &value);
+        if (parsed > p && parsed < token_end) {
+            char* longer;
+            double retry = strtod(p, &longer);
+            if (longer > parsed) {
+                value = retry;
+                parsed = longer;
             }
         }
-        
-        token = strtok(NULL, " \t\n,;[](){}");
+        if (parsed > p && value_list_push(row, value) != 0) return -2;
+        stream->position = (size_t)(token_end - stream->buffer);
     }
-    
-    return count;
+    return row->count;
 }
 
 void extract_matrix_name(const char* filename, char* name) {
@@ -73,210 +231,604 @@ void extract_matrix_name(const char* filename, char* name) {
 
 void debug_file_content(const char* filename) {
     printf("=== DEBUG FILE CONTENT: %s ===\n", filename);
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+    FILE* file = fopen(filename, "rb");
+    text_stream_t stream = { file, (char*)malloc(TEXT_READ_CHUNK + 1), 0, 0, 0 };
+    if (!file || !stream.buffer) {
         printf("Cannot open file for debugging\n");
+        if (file) fclose(file);
+        free(stream.buffer);
         return;
     }
     
-    char line[512];
+    value_list_t row = { NULL, 0, 0 };
+    char comment[128];
     int line_num = 0;
-    while (fgets(line, sizeof(line), file)) {
-        line[strcspn(line, "\n")] = 0;
-        printf("Line %2d: [%s]\n", ++line_num, line);
-        
-        double values[100];
-        int num_values = parse_matrix_line(line, values, 100);
-        printf("       -> Parsed %2d values: ", num_values);
+    int num_values;
+    while ((num_values = stream_next_row(&stream, &row, comment, sizeof(comment))) >= 0) {
+        line_num++;
+        if (comment[0]) {
+            printf("Line %2d: [%s]\n", line_num, comment);
+            continue;
+        }
+        printf("Line %2d: -> Parsed %2d values: ", line_num, num_values);
         for (int i = 0; i < num_values && i < 8; i++) {
-            printf("%6.2f ", values[i]);
+            printf("%6.2f ", row.values[i]);
         }
-        if (num_values > 8 ) printf("... (total: %d)", num_values);
+        if (num_values > 8) printf("... (total: %d)", num_values);
         printf("\n");
     }
+    free(row.values);
+    free(stream.buffer);
     fclose(file);
     printf("=== END DEBUG ===\n\n");
 }
 
-matrix_t* read_matrix_from_file(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("ERROR: Cannot open file: %s\n", filename);
+// Moves the rows read so far from a preallocated matrix to the growing
+// cell list, once the data stops matching the header. Frees the matrix.
+static int spill_rows(matrix_t* matrix, int rows, value_list_t* cells) {
+    int failed = 0;
+    for (int i = 0; i < rows && !failed; i++) {
+        for (int j = 0; j < matrix->cols && !failed; j++) {
+            failed = value_list_push(cells, matrix->data[i][j]) != 0;
+        }
+    }
+    free_matrix(matrix);
+    return failed;
+}
+
+// Progress and error messages from the readers; silent on loader threads.
+static void load_log(int quiet, const char* format, ...) {
+    if (quiet) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// FNV-1a over the header bytes.
+static uint64_t header_checksum(const matrix_file_header_t* header) {
+    const unsigned char* bytes = (const unsigned char*)header;
+    size_t length = offsetof(matrix_file_header_t, header_checksum);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t rotate_left(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Word-at-a-time hash of the payload in four independent lanes, so it runs
+// close to memory bandwidth. Updates may be split anywhere that is a
+// multiple of four words; stored rows always are.
+typedef struct {
+    uint64_t lane[4];
+    uint64_t bytes;
+} payload_hash_t;
+
+static void payload_hash_init(payload_hash_t* hash) {
+    hash->lane[0] = 0x9e3779b97f4a7c15ULL;
+    hash->lane[1] = 0xc2b2ae3d27d4eb4fULL;
+    hash->lane[2] = 0x165667b19e3779f9ULL;
+    hash->lane[3] = 0x27d4eb2f165667c5ULL;
+    hash->bytes = 0;
+}
+
+static uint64_t payload_mix(uint64_t lane, uint64_t word) {
+    return rotate_left(lane ^ (word * 0x9e3779b97f4a7c15ULL), 31) * 0xc2b2ae3d27d4eb4fULL;
+}
+
+static void payload_hash_update(payload_hash_t* hash, const void* data, size_t bytes) {
+    const uint64_t* words = (const uint64_t*)data;
+    size_t count = bytes / sizeof(uint64_t);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        hash->lane[0] = payload_mix(hash->lane[0], words[i]);
+        hash->lane[1] = payload_mix(hash->lane[1], words[i + 1]);
+        hash->lane[2] = payload_mix(hash->lane[2], words[i + 2]);
+        hash->lane[3] = payload_mix(hash->lane[3], words[i + 3]);
+    }
+    for (; i < count; i++) {
+        hash->lane[0] = payload_mix(hash->lane[0], words[i]);
+    }
+    hash->bytes += bytes;
+}
+
+static uint64_t payload_hash_final(const payload_hash_t* hash) {
+    uint64_t result = hash->bytes;
+    for (int l = 0; l < 4; l++) {
+        result = rotate_left(result ^ hash->lane[l], 27) * 0x9e3779b97f4a7c15ULL + 0x85ebca6bULL;
+    }
+    return result;
+}
+
+static int has_binary_magic(const char* filename) {
+    char magic[sizeof(((matrix_file_header_t*)0)->magic)];
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    size_t got = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+    return got == sizeof(magic) && memcmp(magic, MATRIX_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+static int validate_header(const matrix_file_header_t* header, off_t file_size, int quiet) {
+    if (memcmp(header->magic, MATRIX_FILE_MAGIC, sizeof(header->magic)) != 0) return 0;
+    if (header->header_checksum != header_checksum(header)) {
+        load_log(quiet, "ERROR: Header checksum mismatch\n");
+        return 0;
+    }
+    if (header->version != MATRIX_FILE_VERSION) {
+        load_log(quiet, "ERROR: Unsupported .mat version %u\n", header->version);
+        return 0;
+    }
+    if (header->byte_order != MATRIX_FILE_BYTE_ORDER || header->dtype != MATRIX_FILE_DTYPE_F64) {
+        load_log(quiet, "ERROR: .mat file has a foreign byte order or element type\n");
+        return 0;
+    }
+
+    int per_line = MATRIX_ALIGNMENT / (int)sizeof(double);
+    // The same bounds create_matrix enforces; they also keep rows * stride
+    // far from overflowing the payload size check below.
+    if (header->rows <= 0 || header->cols <= 0 || header->stride < header->cols ||
+        header->rows > MATRIX_MAX_DIMENSION || header->stride > MATRIX_MAX_DIMENSION ||
+        header->stride % per_line != 0 || header->payload_offset % MATRIX_ALIGNMENT != 0) {
+        load_log(quiet, "ERROR: Invalid .mat dimensions %dx%d (stride %d)\n",
+               header->rows, header->cols, header->stride);
+        return 0;
+    }
+    uint64_t expected = (uint64_t)header->rows * (uint64_t)header->stride * sizeof(double);
+    // Compared without adding, so a forged offset cannot wrap the sum.
+    if (header->payload_bytes != expected || file_size < 0 ||
+        header->payload_offset > (uint64_t)file_size ||
+        header->payload_bytes > (uint64_t)file_size - header->payload_offset) {
+        load_log(quiet, "ERROR: .mat payload is truncated\n");
+        return 0;
+    }
+    return 1;
+}
+
+static matrix_t* load_binary(const char* filename, int quiet) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        load_log(quiet, "ERROR: Cannot open file: %s\n", filename);
         return NULL;
     }
 
-    printf("Reading matrix from: %s\n", filename);
-    
-    char line[512];
-    int cols = 0;
-    double** temp_data = NULL;
-    int max_rows = 0;
-    char name[50];
-    
-    extract_matrix_name(filename, name);
-    
-    int first_row_cols = 0, second_row_cols = 0;
-    int determined_cols = 0;
-    
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
-        
-        double values[100];
-        int num_values = parse_matrix_line(line, values, 100);
-        
-        if (num_values > 0) {
-            if (first_row_cols == 0) {
-                first_row_cols = num_values;
-                printf("  First row has %d columns\n", first_row_cols);
-            } else if (second_row_cols == 0) {
-                second_row_cols = num_values;
-                printf("  Second row has %d columns\n", second_row_cols);
-                
-                if (first_row_cols == second_row_cols) {
-                    cols = first_row_cols;
-                } else {
-                    cols = (first_row_cols + second_row_cols) / 2;
-                    printf("  WARNING: Column count mismatch! Using average: %d\n", cols);
-                }
-                determined_cols = 1;
+    struct stat st;
+    matrix_file_header_t header;
+    if (fstat(fd, &st) != 0 ||
+        pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        !validate_header(&header, st.st_size, quiet)) {
+        load_log(quiet, "ERROR: Not a valid binary matrix file: %s\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    // Map the payload privately: pages are read on first touch and edits
+    // stay in this process. When the payload is not page aligned, read it
+    // into an anonymous mapping instead so free_matrix can still munmap it.
+    size_t length = (size_t)header.payload_bytes;
+    long page = sysconf(_SC_PAGESIZE);
+    int mapped = page > 0 && header.payload_offset % (uint64_t)page == 0;
+    void* payload;
+    if (mapped) {
+        payload = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)header.payload_offset);
+    } else {
+        payload = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        size_t done = 0;
+        while (payload != MAP_FAILED && done < length) {
+            ssize_t got = pread(fd, (char*)payload + done, length - done,
+                                (off_t)(header.payload_offset + done));
+            if (got <= 0) {
+                munmap(payload, length);
+                payload = MAP_FAILED;
                 break;
             }
+            done += (size_t)got;
         }
     }
-    
-    if (!determined_cols && first_row_cols > 0) {
-        cols = first_row_cols;
-        determined_cols = 1;
-        printf("  Using single row column count: %d\n", cols);
+    close(fd);
+
+    if (payload == MAP_FAILED) {
+        load_log(quiet, "ERROR: Cannot map matrix payload from: %s\n", filename);
+        return NULL;
     }
-    
-    if (!determined_cols) {
-        printf("ERROR: Cannot determine matrix dimensions from file: %s\n", filename);
-        fclose(file);
+
+    payload_hash_t hash;
+    payload_hash_init(&hash);
+    if (global_config.verify_checksums) {
+        payload_hash_update(&hash, payload, length);
+    }
+    if (global_config.verify_checksums && payload_hash_final(&hash) != header.payload_checksum) {
+        load_log(quiet, "ERROR: Payload checksum mismatch in: %s\n", filename);
+        munmap(payload, length);
         return NULL;
     }
-    
-    rewind(file);
-    
+
+    char name[50];
+    header.name[sizeof(header.name) - 1] = '\0';
+    if (header.name[0]) {
+        strncpy(name, header.name, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+    } else {
+        extract_matrix_name(filename, name);
+    }
+
+    matrix_t* matrix = create_matrix_on_mapping(header.rows, header.cols, name,
+                                                (double*)payload, header.stride, length);
+    if (!matrix) {
+        munmap(payload, length);
+        return NULL;
+    }
+
+    load_log(quiet, "SUCCESS: Loaded matrix '%s' (%dx%d) from '%s' (%s)\n", name, header.rows, header.cols,
+           filename, mapped ? "memory-mapped" : "binary");
+    return matrix;
+}
+
+matrix_t* read_matrix_binary(const char* filename) {
+    return load_binary(filename, 0);
+}
+
+// Writes to a temporary file and renames it over the target, so a matrix
+// still mapped from the old file keeps its pages.
+int write_matrix_binary(const matrix_t* matrix, const char* filename) {
+    if (!matrix) {
+        printf("ERROR: Invalid matrix for writing\n");
+        return -1;
+    }
+
+    char temp_name[MAX_FILENAME + 8];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", filename);
+    FILE* file = fopen(temp_name, "wb");
+    if (!file) {
+        printf("ERROR: Cannot create file: %s\n", filename);
+        return -1;
+    }
+
+    int stride = matrix_stride_for(matrix->cols);
+    size_t row_bytes = (size_t)stride * sizeof(double);
+    size_t length = (size_t)matrix->rows * row_bytes;
+
+    matrix_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+    header.version = MATRIX_FILE_VERSION;
+    header.dtype = MATRIX_FILE_DTYPE_F64;
+    header.byte_order = MATRIX_FILE_BYTE_ORDER;
+    header.rows = matrix->rows;
+    header.cols = matrix->cols;
+    header.stride = stride;
+    header.payload_offset = MATRIX_FILE_PAYLOAD_OFFSET;
+    header.payload_bytes = length;
+    strncpy(header.name, matrix->name, sizeof(header.name) - 1);
+
+    // Rows go out with zeroed padding so the checksum does not depend on
+    // whatever sits past cols in memory. The checksum is only known once
+    // the payload is written, so the header is rewritten at the end.
+    double* row = (double*)calloc((size_t)stride, sizeof(double));
+    static const char zeros[MATRIX_FILE_PAYLOAD_OFFSET];
+    int ok = row != NULL && fwrite(zeros, 1, sizeof(zeros), file) == sizeof(zeros);
+
+    payload_hash_t hash;
+    payload_hash_init(&hash);
+    for (int i = 0; ok && i < matrix->rows; i++) {
+        memcpy(row, MATRIX_ROW(matrix, i), (size_t)matrix->cols * sizeof(double));
+        payload_hash_update(&hash, row, row_bytes);
+        ok = fwrite(row, 1, row_bytes, file) == row_bytes;
+    }
+    free(row);
+
+    header.payload_checksum = payload_hash_final(&hash);
+    header.header_checksum = header_checksum(&header);
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    if (fclose(file) != 0) ok = 0;
+    if (!ok || rename(temp_name, filename) != 0) {
+        remove(temp_name);
+        printf("ERROR: Failed to write binary matrix: %s\n", filename);
+        return -1;
+    }
+
+    printf("SUCCESS: Saved matrix '%s' to '%s'\n", matrix->name, filename);
+    return 0;
+}
+
+static int has_extension(const char* filename, const char* extension) {
+    const char* dot = strrchr(filename, '.');
+    return dot && strcmp(dot, extension) == 0;
+}
+
+// Single pass over the file. A "# Matrix: name RxC" header before the
+// first row (as write_matrix_to_file emits) sizes the matrix up front and
+// rows are parsed straight into it; otherwise the first row fixes the
+// column count and rows collect in a growing buffer. Rows whose length is
+// off by more than half are skipped, the rest padded or truncated.
+static matrix_t* load_text(const char* filename, int quiet) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        load_log(quiet, "ERROR: Cannot open file: %s\n", filename);
+        return NULL;
+    }
+
+    load_log(quiet, "Reading matrix from: %s\n", filename);
+
+    char name[50];
+    extract_matrix_name(filename, name);
+
+    text_stream_t stream = { file, (char*)malloc(TEXT_READ_CHUNK + 1), 0, 0, 0 };
+    value_list_t row = { NULL, 0, 0 };
+    value_list_t cells = { NULL, 0, 0 };
+    matrix_t* matrix = NULL;
+    char comment[128];
+    int declared_rows = 0, declared_cols = 0;
+    int cols = 0;
     int valid_rows = 0;
     int skipped_rows = 0;
-    
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
-        
-        double values[100];
-        int num_values = parse_matrix_line(line, values, 100);
-        
-        if (num_values > 0) {
-            if (abs(num_values - cols) > cols / 2) {
-                printf("  WARNING: Skipping row %d - has %d values, expected ~%d\n", 
-                       valid_rows + 1, num_values, cols);
-                skipped_rows++;
-                continue;
+    int failed = stream.buffer == NULL;
+
+    // The "# Matrix: name RxC" header is only a hint to preallocate; the
+    // shape always comes from the data, as for files without one.
+    struct stat st;
+    double file_bytes = fstat(fileno(file), &st) == 0 ? (double)st.st_size : 0.0;
+
+    while (!failed) {
+        int count = stream_next_row(&stream, &row, comment, sizeof(comment));
+        if (count < 0) {
+            failed = count == -2 || ferror(file);
+            break;
+        }
+        if (count == 0) {
+            int r, c;
+            if (cols == 0 && declared_rows == 0 &&
+                sscanf(comment, "# Matrix: %*s %dx%d", &r, &c) == 2 && r > 0 && c > 0 &&
+                (double)r * c * TEXT_MIN_CELL_BYTES <= file_bytes) {
+                declared_rows = r;
+                declared_cols = c;
             }
-            
-            if (valid_rows >= max_rows) {
-                max_rows = (max_rows == 0) ? 10 : max_rows * 2;
-                temp_data = realloc(temp_data, max_rows * sizeof(double*));
-                for (int i = valid_rows; i < max_rows; i++) {
-                    temp_data[i] = malloc(cols * sizeof(double));
-                    for (int j = 0; j < cols; j++) {
-                        temp_data[i][j] = 0.0;
-                    }
+            continue;
+        }
+
+        if (cols == 0) {
+            cols = count;
+            if (count == declared_cols) {
+                matrix = create_matrix(declared_rows, declared_cols, name);
+                if (!matrix) {
+                    failed = 1;
+                    break;
                 }
             }
-            
-            int copy_count = (num_values < cols) ? num_values : cols;
-            for (int j = 0; j < copy_count; j++) {
-                temp_data[valid_rows][j] = values[j];
-            }
-            
-            for (int j = copy_count; j < cols; j++) {
-                temp_data[valid_rows][j] = 0.0;
+        }
+
+        if (abs(count - cols) > cols / 2) {
+            load_log(quiet, "  WARNING: Skipping row %d - has %d values, expected ~%d\n",
+                     valid_rows + skipped_rows + 1, count, cols);
+            skipped_rows++;
+            continue;
+        }
+
+        int copy_count = count < cols ? count : cols;
+        if (matrix && valid_rows == matrix->rows) {
+            failed = spill_rows(matrix, valid_rows, &cells);
+            matrix = NULL;
+            if (failed) break;
+        }
+        if (matrix) {
+            double* target = matrix->data[valid_rows];
+            memcpy(target, row.values, (size_t)copy_count * sizeof(double));
+            memset(target + copy_count, 0, (size_t)(cols - copy_count) * sizeof(double));
+        } else {
+            for (int j = 0; j < cols && !failed; j++) {
+                failed = value_list_push(&cells, j < copy_count ? row.values[j] : 0.0) != 0;
             }
-            
-            valid_rows++;
         }
+        valid_rows++;
     }
-    
+
     fclose(file);
-    
-    if (valid_rows == 0) {
-        printf("ERROR: No valid data found in file: %s\n", filename);
-        if (temp_data) {
-            for (int i = 0; i < max_rows; i++) free(temp_data[i]);
-            free(temp_data);
+    free(stream.buffer);
+    free(row.values);
+
+    if (failed || valid_rows == 0) {
+        if (failed) {
+            load_log(quiet, "ERROR: Failed to read matrix data from: %s\n", filename);
+        } else if (cols == 0) {
+            load_log(quiet, "ERROR: Cannot determine matrix dimensions from file: %s\n", filename);
+        } else {
+            load_log(quiet, "ERROR: No valid data found in file: %s\n", filename);
         }
+        free(cells.values);
+        free_matrix(matrix);
         return NULL;
     }
-    
-    matrix_t* matrix = create_matrix(valid_rows, cols, name);
-    if (!matrix) {
-        printf("ERROR: Failed to create matrix structure for: %s\n", filename);
-        for (int i = 0; i < max_rows; i++) free(temp_data[i]);
-        free(temp_data);
-        return NULL;
+
+    if (matrix && valid_rows < matrix->rows) {
+        failed = spill_rows(matrix, valid_rows, &cells);
+        matrix = NULL;
+        if (failed) {
+            load_log(quiet, "ERROR: Failed to read matrix data from: %s\n", filename);
+            free(cells.values);
+            return NULL;
+        }
     }
-    
-    for (int i = 0; i < valid_rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            matrix->data[i][j] = temp_data[i][j];
+    if (!matrix) {
+        matrix = create_matrix(valid_rows, cols, name);
+        if (!matrix) {
+            load_log(quiet, "ERROR: Failed to create matrix structure for: %s\n", filename);
+            free(cells.values);
+            return NULL;
+        }
+        for (int i = 0; i < valid_rows; i++) {
+            memcpy(matrix->data[i], cells.values + (size_t)i * cols, (size_t)cols * sizeof(double));
         }
-        free(temp_data[i]);
     }
-    free(temp_data);
-    
-    printf("SUCCESS: Loaded matrix '%s' (%dx%d) from '%s'", name, valid_rows, cols, filename);
+    free(cells.values);
+
+    load_log(quiet, "SUCCESS: Loaded matrix '%s' (%dx%d) from '%s'", name, valid_rows, cols, filename);
     if (skipped_rows > 0) {
-        printf(" (skipped %d rows)", skipped_rows);
+        load_log(quiet, " (skipped %d rows)", skipped_rows);
     }
-    printf("\n");
-    
+    load_log(quiet, "\n");
+
+    return matrix;
+}
+
+static matrix_t* load_matrix_file(const char* filename, int quiet) {
+    long long span = trace_begin();
+    matrix_t* matrix = has_binary_magic(filename) ? load_binary(filename, quiet)
+                                                  : load_text(filename, quiet);
+    trace_end("file_parse", span);
     return matrix;
 }
 
+matrix_t* read_matrix_from_file(const char* filename) {
+    return load_matrix_file(filename, 0);
+}
+
+matrix_t* read_matrix_quiet(const char* filename) {
+    return load_matrix_file(filename, 1);
+}
+
+static int write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+static size_t format_rows(const matrix_t* matrix, int first, int last, char* out) {
+    size_t used = 0;
+    for (int i = first; i < last; i++) {
+        const double* row = MATRIX_ROW(matrix, i);
+        for (int j = 0; j < matrix->cols; j++) {
+            used += (size_t)format_double(row[j], out + used);
+            out[used++] = j < matrix->cols - 1 ? ' ' : '\n';
+        }
+    }
+    return used;
+}
+
+// Numbers are formatted with format_double into one buffer per thread,
+// each holding a group of about TEXT_WRITE_CHUNK bytes of rows. Groups are
+// formatted concurrently and written in order, a buffer per write() call,
+// so saving is bound by I/O rather than printf.
+int write_matrix_text(const matrix_t* matrix, const char* filename) {
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    int threads = 1;
+    #ifdef _OPENMP
+    threads = omp_get_max_threads();
+    #endif
+    size_t row_bytes = (size_t)matrix->cols * FLOAT_FORMAT_MAX_CHARS;
+    int group_rows = (int)(TEXT_WRITE_CHUNK / row_bytes);
+    if (group_rows < 1) group_rows = 1;
+    if (group_rows > matrix->rows) group_rows = matrix->rows;
+    int groups = (matrix->rows + group_rows - 1) / group_rows;
+    if (threads > groups) threads = groups;
+
+    char** buffers = (char**)calloc((size_t)threads, sizeof(char*));
+    size_t* lengths = (size_t*)calloc((size_t)threads, sizeof(size_t));
+    int ok = buffers && lengths;
+    for (int t = 0; ok && t < threads; t++) {
+        buffers[t] = (char*)malloc((size_t)group_rows * row_bytes);
+        ok = buffers[t] != NULL;
+    }
+
+    char header[128];
+    int header_length = snprintf(header, sizeof(header), "# Matrix: %s %dx%d\n# Generated by Matrix Operations System\n",
+                                 matrix->name, matrix->rows, matrix->cols);
+    ok = ok && write_all(fd, header, (size_t)header_length) == 0;
+
+    for (int first = 0; ok && first < matrix->rows; first += group_rows * threads) {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1) num_threads(threads) if(threads > 1)
+        #endif
+        for (int t = 0; t < threads; t++) {
+            int start = first + t * group_rows;
+            int end = start + group_rows < matrix->rows ? start + group_rows : matrix->rows;
+            lengths[t] = start < end ? format_rows(matrix, start, end, buffers[t]) : 0;
+        }
+        for (int t = 0; ok && t < threads; t++) {
+            ok = write_all(fd, buffers[t], lengths[t]) == 0;
+        }
+    }
+
+    if (buffers) {
+        for (int t = 0; t < threads; t++) free(buffers[t]);
+    }
+    free(buffers);
+    free(lengths);
+    if (close(fd) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
 int write_matrix_to_file(const matrix_t* matrix, const char* filename) {
     if (!matrix) {
         printf("ERROR: Invalid matrix for writing\n");
         return -1;
     }
 
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        printf("ERROR: Cannot create file: %s\n", filename);
-        return -1;
+    if (has_extension(filename, ".mat")) {
+        return write_matrix_binary(matrix, filename);
     }
 
-    fprintf(file, "# Matrix: %s %dx%d\n", matrix->name, matrix->rows, matrix->cols);
-    fprintf(file, "# Generated by Matrix Operations System\n");
-
-    for (int i = 0; i < matrix->rows; i++) {
-        for (int j = 0; j < matrix->cols; j++) {
-            fprintf(file, "%.6f", matrix->data[i][j]);
-            if (j < matrix->cols - 1) fprintf(file, " ");
-        }
-        fprintf(file, "\n");
+    if (write_matrix_text(matrix, filename) != 0) {
+        printf("ERROR: Cannot write file: %s\n", filename);
+        return -1;
     }
-
-    fclose(file);
     printf("SUCCESS: Saved matrix '%s' to '%s'\n", matrix->name, filename);
     return 0;
 }
 
-void get_matrix_files(const char* folder_path, char files[][MAX_FILENAME], int* count) {
+// Orders by file name without extension, then by extension, so a name's
+// .mat and .txt files end up next to each other.
+static int compare_matrix_paths(const void* a, const void* b) {
+    const char* x = (const char*)a;
+    const char* y = (const char*)b;
+    const char* x_dot = strrchr(x, '.');
+    const char* y_dot = strrchr(y, '.');
+    size_t x_stem = x_dot ? (size_t)(x_dot - x) : strlen(x);
+    size_t y_stem = y_dot ? (size_t)(y_dot - y) : strlen(y);
+    int order = strncmp(x, y, x_stem < y_stem ? x_stem : y_stem);
+    if (order != 0) return order;
+    if (x_stem != y_stem) return x_stem < y_stem ? -1 : 1;
+    return strcmp(x + x_stem, y + y_stem);
+}
+
+matrix_path_t* get_matrix_files(const char* folder_path, int* count) {
+    *count = 0;
     DIR* dir = opendir(folder_path);
     if (!dir) {
         printf("ERROR: Cannot open directory: %s\n", folder_path);
-        *count = 0;
-        return;
+        return NULL;
     }
 
     struct dirent* entry;
-    *count = 0;
+    matrix_path_t* files = NULL;
+    int capacity = 0;
 
-    while ((entry = readdir(dir)) != NULL && *count < MAX_MATRICES) {
+    while ((entry = readdir(dir)) != NULL) {
         char* ext = strrchr(entry->d_name, '.');
         if (ext && (strcmp(ext, ".txt") == 0 || strcmp(ext, ".mat") == 0)) {
+            if (*count == capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                matrix_path_t* grown = (matrix_path_t*)realloc(files, (size_t)capacity * sizeof(matrix_path_t));
+                if (!grown) {
+                    printf("ERROR: Out of memory listing directory: %s\n", folder_path);
+                    break;
+                }
+                files = grown;
+            }
 
             int path_len = snprintf(files[*count], MAX_FILENAME - 1, "%s/%s", folder_path, entry->d_name);
             if (path_len >= MAX_FILENAME) {
@@ -289,49 +841,98 @@ void get_matrix_files(const char* folder_path, char files[][MAX_FILENAME], int*
     }
 
     closedir(dir);
+
+    // Sorted order keeps loading (and so IDs) independent of readdir order.
+    // A .mat saved next to a text file of the same name supersedes it; the
+    // two sort next to each other.
+    qsort(files, (size_t)*count, sizeof(matrix_path_t), compare_matrix_paths);
+    int kept = 0;
+    for (int i = 0; i < *count; i++) {
+        if (kept > 0 && has_extension(files[i], ".txt") && has_extension(files[kept - 1], ".mat")) {
+            size_t stem = strlen(files[i]) - 4;
+            if (strlen(files[kept - 1]) == stem + 4 && strncmp(files[i], files[kept - 1], stem) == 0) {
+                continue;
+            }
+        }
+        if (kept != i) memcpy(files[kept], files[i], sizeof(matrix_path_t));
+        kept++;
+    }
+    *count = kept;
+    return files;
 }
 
 int read_matrices_from_folder(const char* folder_path) {
     printf("\n=== LOADING MATRICES FROM: %s ===\n", folder_path);
     
-    char files[MAX_MATRICES][MAX_FILENAME];
     int file_count = 0;
-
-    get_matrix_files(folder_path, files, &file_count);
+    matrix_path_t* files = get_matrix_files(folder_path, &file_count);
 
     if (file_count == 0) {
         printf("No matrix files found in '%s'\n", folder_path);
+        free(files);
         return 0;
     }
 
-    printf("Found %d matrix files\n", file_count);
-
     int loaded_count = 0;
     int failed_count = 0;
-    
-    for (int i = 0; i < file_count; i++) {
-        printf("\n[%d/%d] ", i + 1, file_count);
-        
-        matrix_t* matrix = read_matrix_from_file(files[i]);
-        if (matrix) {
+    int registry_full = 0;
+    matrix_t* batch[FOLDER_LOAD_BATCH];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Files are parsed concurrently one batch at a time, so at most
+    // FOLDER_LOAD_BATCH unregistered matrices are held at once, then
+    // registered in name order on this thread.
+    for (int first = 0; first < file_count && !registry_full; first += FOLDER_LOAD_BATCH) {
+        int size = file_count - first < FOLDER_LOAD_BATCH ? file_count - first : FOLDER_LOAD_BATCH;
+        int batch_first_id = next_matrix_id;
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) if(size > 1)
+        #endif
+        for (int i = 0; i < size; i++) {
+            batch[i] = load_matrix_file(files[first + i], 1);
+        }
+
+        // IDs drawn while parsing depend on thread timing; hand them out
+        // again in name order.
+        next_matrix_id = batch_first_id;
+        for (int i = 0; i < size; i++) {
+            matrix_t* matrix = batch[i];
+            if (!matrix) {
+                printf("Failed to load: %s\n", files[first + i]);
+                failed_count++;
+                continue;
+            }
+            if (registry_full) {
+                free_matrix(matrix);
+                continue;
+            }
+            matrix->id = next_matrix_id++;
             if (add_matrix_to_registry(matrix) >= 0) {
                 loaded_count++;
             } else {
                 printf("ERROR: Matrix registry full! Cannot add: %s\n", matrix->name);
                 free_matrix(matrix);
-                failed_count++;
+                next_matrix_id--;
+                registry_full = 1;
             }
-        } else {
-            failed_count++;
         }
     }
 
-    printf("\n=== LOADING SUMMARY ===\n");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("=== LOADING SUMMARY ===\n");
     printf("Successfully loaded: %d matrices\n", loaded_count);
     printf("Failed to load: %d matrices\n", failed_count);
-    printf("Total files processed: %d\n", file_count);
+    if (registry_full) {
+        printf("Skipped: %d matrices (registry full)\n", file_count - loaded_count - failed_count);
+    }
+    printf("Total files processed: %d in %.3f seconds\n", file_count, elapsed);
     printf("========================\n");
     
+    free(files);
     return loaded_count;
 }
 
@@ -350,12 +951,12 @@ int write_matrices_to_folder(const char* folder_path) {
     int saved_count = 0;
     int total_count = 0;
     
-    for (int i = 0; i < MAX_MATRICES; i++) {
+    for (int i = 0; i < matrix_registry_capacity; i++) {
         if (matrix_registry[i]) {
             total_count++;
             char filename[MAX_FILENAME];
-            snprintf(filename, sizeof(filename), "%s/%s.txt", 
-                    folder_path, matrix_registry[i]->name);
+            snprintf(filename, sizeof(filename), "%s/%s.%s", folder_path,
+                     matrix_registry[i]->name, global_config.save_binary ? "mat" : "txt");
             
             if (write_matrix_to_file(matrix_registry[i], filename) == 0) {
                 saved_count++;
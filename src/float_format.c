@@ -0,0 +1,268 @@
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../include/float_format.h"
+
+// Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers"). A double v is bracketed by the midpoints to its
+// neighbours, everything is scaled by a cached power of ten into a 64-bit
+// window, and digits are generated until the remainder falls inside the
+// bracket. The result always reads back to v and is usually the shortest
+// such string; Grisu2 has no exactness check, so about 0.1% of doubles get
+// more digits than needed.
+
+typedef struct {
+    uint64_t f;
+    int e;
+} diy_fp_t;
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_EXPONENT_MASK 0x7FF0000000000000ULL
+#define DP_HIDDEN_BIT 0x0010000000000000ULL
+#define DP_EXPONENT_BIAS (0x3FF + 52)
+
+// 10^(-348 + 8i) as normalized 64-bit significand and binary exponent.
+static const diy_fp_t cached_powers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 }, { 0x8b16fb203055ac76ULL, -1166 },
+    { 0xcf42894a5dce35eaULL, -1140 }, { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+    { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 }, { 0xbe5691ef416bd60cULL, -1007 },
+    { 0x8dd01fad907ffc3cULL, -980 }, { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+    { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 }, { 0x823c12795db6ce57ULL, -847 },
+    { 0xc21094364dfb5637ULL, -821 }, { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+    { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 }, { 0xb23867fb2a35b28eULL, -688 },
+    { 0x84c8d4dfd2c63f3bULL, -661 }, { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+    { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 }, { 0xf3e2f893dec3f126ULL, -529 },
+    { 0xb5b5ada8aaff80b8ULL, -502 }, { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+    { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 }, { 0xa6dfbd9fb8e5b88fULL, -369 },
+    { 0xf8a95fcf88747d94ULL, -343 }, { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+    { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 }, { 0xe45c10c42a2b3b06ULL, -210 },
+    { 0xaa242499697392d3ULL, -183 }, { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+    { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 }, { 0x9c40000000000000ULL, -50 },
+    { 0xe8d4a51000000000ULL, -24 }, { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+    { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 }, { 0xd5d238a4abe98068ULL, 109 },
+    { 0x9f4f2726179a2245ULL, 136 }, { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+    { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 }, { 0x924d692ca61be758ULL, 269 },
+    { 0xda01ee641a708deaULL, 295 }, { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+    { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 }, { 0xc83553c5c8965d3dULL, 428 },
+    { 0x952ab45cfa97a0b3ULL, 455 }, { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+    { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 }, { 0x88fcf317f22241e2ULL, 588 },
+    { 0xcc20ce9bd35c78a5ULL, 614 }, { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+    { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 }, { 0xbb764c4ca7a44410ULL, 747 },
+    { 0x8bab8eefb6409c1aULL, 774 }, { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+    { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 }, { 0x80444b5e7aa7cf85ULL, 907 },
+    { 0xbf21e44003acdd2dULL, 933 }, { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+    { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 }, { 0xaf87023b9bf0ee6bULL, 1066 },
+};
+
+static const uint32_t powers_of_ten[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// High 64 bits of the 128-bit product, rounded, from 32-bit halves.
+static diy_fp_t diy_multiply(diy_fp_t a, diy_fp_t b) {
+    const uint64_t mask = 0xFFFFFFFFULL;
+    uint64_t a_high = a.f >> 32, a_low = a.f & mask;
+    uint64_t b_high = b.f >> 32, b_low = b.f & mask;
+    uint64_t high_high = a_high * b_high;
+    uint64_t high_low = a_high * b_low;
+    uint64_t low_high = a_low * b_high;
+    uint64_t low_low = a_low * b_low;
+    uint64_t middle = (low_low >> 32) + (high_low & mask) + (low_high & mask);
+    middle += 1ULL << 31;  // round to nearest
+    diy_fp_t result = { high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32), a.e + b.e + 64 };
+    return result;
+}
+
+static diy_fp_t diy_normalize(diy_fp_t x) {
+    int shift = __builtin_clzll(x.f);
+    diy_fp_t result = { x.f << shift, x.e - shift };
+    return result;
+}
+
+static diy_fp_t diy_from_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased = (int)((bits & DP_EXPONENT_MASK) >> 52);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    diy_fp_t result;
+    if (biased != 0) {
+        result.f = significand + DP_HIDDEN_BIT;
+        result.e = biased - DP_EXPONENT_BIAS;
+    } else {
+        result.f = significand;
+        result.e = 1 - DP_EXPONENT_BIAS;
+    }
+    return result;
+}
+
+// Midpoints between v and its neighbours, both with the exponent of the
+// normalized upper one.
+static void diy_boundaries(diy_fp_t v, diy_fp_t* minus, diy_fp_t* plus) {
+    diy_fp_t upper = { (v.f << 1) + 1, v.e - 1 };
+    while (!(upper.f & (DP_HIDDEN_BIT << 1))) {
+        upper.f <<= 1;
+        upper.e--;
+    }
+    upper.f <<= 64 - 52 - 2;
+    upper.e -= 64 - 52 - 2;
+
+    // The gap below a power of two is half the gap above it.
+    diy_fp_t lower = v.f == DP_HIDDEN_BIT ? (diy_fp_t){ (v.f << 2) - 1, v.e - 2 }
+                                          : (diy_fp_t){ (v.f << 1) - 1, v.e - 1 };
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+    *plus = upper;
+    *minus = lower;
+}
+
+// Cached power c = 10^-k such that e + c.e + 64 lands in [-60, -32].
+static diy_fp_t cached_power_for(int e, int* k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int estimate = (int)dk;
+    if (dk - estimate > 0.0) estimate++;
+    unsigned index = (unsigned)((estimate >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return cached_powers[index];
+}
+
+static int count_decimal_digits(uint32_t n) {
+    int digits = 1;
+    while (digits < 10 && n >= powers_of_ten[digits]) digits++;
+    return digits;
+}
+
+// Nudges the last digit down while that moves the result closer to the
+// scaled value w without leaving the safe interval.
+static void grisu_round(char* buffer, int length, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static void digit_gen(diy_fp_t w, diy_fp_t mp, uint64_t delta, char* buffer, int* length, int* k) {
+    diy_fp_t one = { 1ULL << -mp.e, mp.e };
+    uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = count_decimal_digits(p1);
+    *length = 0;
+
+    while (kappa > 0) {
+        uint32_t divisor = powers_of_ten[kappa - 1];
+        uint32_t digit = p1 / divisor;
+        p1 %= divisor;
+        if (digit || *length) buffer[(*length)++] = (char)('0' + digit);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            grisu_round(buffer, *length, delta, rest, (uint64_t)powers_of_ten[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char digit = (char)(p2 >> -one.e);
+        if (digit || *length) buffer[(*length)++] = (char)('0' + digit);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            int index = -kappa;
+            grisu_round(buffer, *length, delta, p2, one.f, wp_w * (index < 10 ? powers_of_ten[index] : 0));
+            return;
+        }
+    }
+}
+
+// Digits of a positive finite value; value == digits * 10^k.
+static int grisu2(double value, char* digits, int* k) {
+    diy_fp_t v = diy_from_double(value);
+    diy_fp_t minus, plus;
+    diy_boundaries(v, &minus, &plus);
+
+    diy_fp_t c = cached_power_for(plus.e, k);
+    diy_fp_t w = diy_multiply(diy_normalize(v), c);
+    diy_fp_t wp = diy_multiply(plus, c);
+    diy_fp_t wm = diy_multiply(minus, c);
+    wm.f++;
+    wp.f--;
+
+    int length;
+    digit_gen(w, wp, wp.f - wm.f, digits, &length, k);
+    return length;
+}
+
+static int write_exponent(int exponent, char* out) {
+    int n = 0;
+    out[n++] = 'e';
+    if (exponent < 0) {
+        out[n++] = '-';
+        exponent = -exponent;
+    }
+    if (exponent >= 100) out[n++] = (char)('0' + exponent / 100);
+    if (exponent >= 10) out[n++] = (char)('0' + exponent / 10 % 10);
+    out[n++] = (char)('0' + exponent % 10);
+    return n;
+}
+
+int format_double(double value, char* out) {
+    int n = 0;
+    if (isnan(value)) {
+        memcpy(out, "nan", 4);
+        return 3;
+    }
+    if (signbit(value)) {
+        out[n++] = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(out + n, "inf", 4);
+        return n + 3;
+    }
+    if (value == 0.0) {
+        out[n++] = '0';
+        out[n] = '\0';
+        return n;
+    }
+
+    char digits[20];
+    int k;
+    int length = grisu2(value, digits, &k);
+    int point = length + k;  // value = 0.digits * 10^point
+
+    if (k >= 0 && point <= 17) {
+        // Integer: digits then zeros.
+        memcpy(out + n, digits, (size_t)length);
+        n += length;
+        for (int i = 0; i < k; i++) out[n++] = '0';
+    } else if (point > 0 && point <= 17) {
+        memcpy(out + n, digits, (size_t)point);
+        n += point;
+        out[n++] = '.';
+        memcpy(out + n, digits + point, (size_t)(length - point));
+        n += length - point;
+    } else if (point > -5 && point <= 0) {
+        out[n++] = '0';
+        out[n++] = '.';
+        for (int i = point; i < 0; i++) out[n++] = '0';
+        memcpy(out + n, digits, (size_t)length);
+        n += length;
+    } else {
+        out[n++] = digits[0];
+        if (length > 1) {
+            out[n++] = '.';
+            memcpy(out + n, digits + 1, (size_t)(length - 1));
+            n += length - 1;
+        }
+        n += write_exponent(point - 1, out + n);
+    }
+    out[n] = '\0';
+    return n;
+}
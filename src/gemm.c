@@ -0,0 +1,169 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/gemm.h"
+#include "../include/matrix_operations.h"
+#include "../include/simd_kernels.h"
+#include "../include/trace.h"
+
+static int min_int(int a, int b) {
+    return a < b ? a : b;
+}
+
+static double* gemm_alloc(size_t count) {
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, MATRIX_ALIGNMENT, count * sizeof(double)) != 0) {
+        return NULL;
+    }
+    return (double*)buffer;
+}
+
+// Unpacked i-k-j kernel for products too small to amortize packing.
+static void gemm_small(int m, int n, int k, double alpha,
+                       const double* A, int lda,
+                       const double* B, int ldb,
+                       double* C, int ldc) {
+    for (int i = 0; i < m; i++) {
+        const double* a = A + (size_t)i * lda;
+        double* c = C + (size_t)i * ldc;
+        for (int p = 0; p < k; p++) {
+            simd_kernels.vector_axpy(alpha * a[p], B + (size_t)p * ldb, c, n);
+        }
+    }
+}
+
+// Packs an mc x kc block of A into mr-row micro-panels, scaled by alpha.
+// Rows past mc are zero-filled so the micro-kernel never branches.
+static void pack_a(int mc, int kc, int mr_tile, double alpha, const double* A, int lda, double* Ap) {
+    for (int ir = 0; ir < mc; ir += mr_tile) {
+        int mr = min_int(mr_tile, mc - ir);
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < mr; i++) {
+                Ap[i] = alpha * A[(size_t)(ir + i) * lda + p];
+            }
+            for (int i = mr; i < mr_tile; i++) {
+                Ap[i] = 0.0;
+            }
+            Ap += mr_tile;
+        }
+    }
+}
+
+// Packs a kc x nr sliver of B into one nr_tile-wide micro-panel.
+static void pack_b_panel(int kc, int nr, int nr_tile, const double* B, int ldb, double* Bp) {
+    for (int p = 0; p < kc; p++) {
+        const double* b = B + (size_t)p * ldb;
+        for (int j = 0; j < nr; j++) {
+            Bp[j] = b[j];
+        }
+        for (int j = nr; j < nr_tile; j++) {
+            Bp[j] = 0.0;
+        }
+        Bp += nr_tile;
+    }
+}
+
+static void gemm_macro_kernel(const simd_kernels_t* kernels, int mc, int nc, int kc,
+                              const double* Ap, const double* Bp, double* C, int ldc) {
+    int mr_tile = kernels->gemm_mr;
+    int nr_tile = kernels->gemm_nr;
+    for (int jr = 0; jr < nc; jr += nr_tile) {
+        int nr = min_int(nr_tile, nc - jr);
+        for (int ir = 0; ir < mc; ir += mr_tile) {
+            int mr = min_int(mr_tile, mc - ir);
+            kernels->gemm_micro_kernel(kc, Ap + (size_t)ir * kc, Bp + (size_t)jr * kc,
+                                       C + (size_t)ir * ldc + jr, ldc, mr, nr);
+        }
+    }
+}
+
+void gemm_compute(int m, int n, int k, double alpha,
+                  const double* A, int lda,
+                  const double* B, int ldb,
+                  double* C, int ldc, int parallel) {
+    if (m <= 0 || n <= 0 || k <= 0 || alpha == 0.0) return;
+
+    if ((double)m * n * k < GEMM_SMALL_WORK) {
+        gemm_small(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    const simd_kernels_t* kernels = &simd_kernels;
+    int mr_tile = kernels->gemm_mr;
+    int nr_tile = kernels->gemm_nr;
+    int threads = 1;
+    int mc_block = GEMM_MC / mr_tile * mr_tile;
+    #ifdef _OPENMP
+    if (parallel) {
+        threads = omp_get_max_threads();
+        // Shrink the row blocks until every thread has a macro-tile to work on.
+        while (mc_block > mr_tile && (m + mc_block - 1) / mc_block < threads) {
+            mc_block -= mr_tile;
+        }
+    }
+    #else
+    (void)parallel;
+    #endif
+
+    int kc_max = min_int(k, GEMM_KC);
+    int nc_max = (min_int(n, GEMM_NC) + nr_tile - 1) / nr_tile * nr_tile;
+    size_t a_block = (size_t)mc_block * kc_max;
+
+    double* Bp = gemm_alloc((size_t)kc_max * nc_max);
+    double* Ap_all = gemm_alloc(a_block * threads);
+    if (!Bp || !Ap_all) {
+        printf("GEMM: packing buffer allocation failed, using direct kernel\n");
+        free(Bp);
+        free(Ap_all);
+        gemm_small(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    #endif
+    {
+        // One span per thread shows how evenly the macro-tiles were shared.
+        long long span = trace_begin();
+        int thread_id = 0;
+        #ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+        #endif
+        double* Ap = Ap_all + a_block * thread_id;
+
+        for (int jc = 0; jc < n; jc += GEMM_NC) {
+            int nc = min_int(GEMM_NC, n - jc);
+            int b_panels = (nc + nr_tile - 1) / nr_tile;
+
+            for (int pc = 0; pc < k; pc += GEMM_KC) {
+                int kc = min_int(GEMM_KC, k - pc);
+
+                #ifdef _OPENMP
+                #pragma omp for
+                #endif
+                for (int panel = 0; panel < b_panels; panel++) {
+                    int jr = panel * nr_tile;
+                    pack_b_panel(kc, min_int(nr_tile, nc - jr), nr_tile,
+                                 B + (size_t)pc * ldb + jc + jr, ldb,
+                                 Bp + (size_t)jr * kc);
+                }
+
+                #ifdef _OPENMP
+                #pragma omp for schedule(dynamic)
+                #endif
+                for (int ic = 0; ic < m; ic += mc_block) {
+                    int mc = min_int(mc_block, m - ic);
+                    pack_a(mc, kc, mr_tile, alpha, A + (size_t)ic * lda + pc, lda, Ap);
+                    gemm_macro_kernel(kernels, mc, nc, kc, Ap, Bp, C + (size_t)ic * ldc + jc, ldc);
+                }
+            }
+        }
+        trace_end("gemm_thread", span);
+    }
+
+    free(Bp);
+    free(Ap_all);
+}
@@ -0,0 +1,381 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "../include/krylov_eigen.h"
+#include "../include/eigen_solver.h"
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/config.h"
+
+// Arnoldi factorization A V^T = V^T H + f e_m^T. The basis vectors are the
+// rows of V, so every update is a contiguous axpy or dot product. H is a
+// dense m x m array with leading dimension m.
+typedef struct {
+    int n;
+    int m;
+    int ld;
+    double* V;
+    double* V_next;  // scratch basis for restarts
+    double* H;
+    double* Q;       // accumulated restart rotation, m x m
+    double* M;       // shift polynomial being factored, m x m
+    double* f;
+    double* h;
+    double scale;    // largest ||A v|| seen, for breakdown detection
+    unsigned seed;
+    int symmetric;
+    eigen_matvec_fn matvec;
+    void* context;
+} krylov_t;
+
+#define KV(K, i) ((K)->V + (size_t)(i) * (K)->ld)
+#define KH(K, i, j) ((K)->H[(size_t)(i) * (K)->m + (j)])
+
+static double* krylov_alloc(size_t count) {
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, MATRIX_ALIGNMENT, count * sizeof(double)) != 0) {
+        return NULL;
+    }
+    memset(buffer, 0, count * sizeof(double));
+    return (double*)buffer;
+}
+
+static void random_vector(krylov_t* K, double* x) {
+    for (int i = 0; i < K->n; i++) {
+        K->seed = K->seed * 1103515245u + 12345u;
+        x[i] = (double)((K->seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+    }
+}
+
+// Projects x off basis rows 0..rows-1 with classical Gram-Schmidt, repeated
+// once when cancellation is heavy (DGKS). Coefficients are added to coeff
+// when it is not NULL. Returns ||x|| afterwards.
+static double orthogonalize(krylov_t* K, int rows, double* x, double* coeff) {
+    double before = sqrt(simd_kernels.vector_dot(x, x, K->n));
+    double after = before;
+
+    for (int pass = 0; pass < 2; pass++) {
+        double* c = K->h + K->m;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if(is_openmp_enabled() && K->n >= EIGEN_PARALLEL_MIN_ROWS * 16)
+        #endif
+        for (int i = 0; i < rows; i++) {
+            c[i] = simd_kernels.vector_dot(KV(K, i), x, K->n);
+        }
+        for (int i = 0; i < rows; i++) {
+            simd_kernels.vector_axpy(-c[i], KV(K, i), x, K->n);
+            if (coeff) coeff[i] += c[i];
+        }
+
+        after = sqrt(simd_kernels.vector_dot(x, x, K->n));
+        if (after > 0.717 * before) break;
+        before = after;
+    }
+    return after;
+}
+
+// Grows the factorization from start to m basis vectors; f holds the
+// residual of the start-step factorization on entry and of the m-step one
+// on return.
+static void krylov_extend(krylov_t* K, int start) {
+    for (int j = start; j < K->m; j++) {
+        double beta = sqrt(simd_kernels.vector_dot(K->f, K->f, K->n));
+        double* v = KV(K, j);
+
+        if (j > 0 && beta <= DBL_EPSILON * K->scale) {
+            // Invariant subspace found: continue from a fresh direction.
+            do {
+                random_vector(K, v);
+                beta = orthogonalize(K, j, v, NULL);
+            } while (beta == 0.0);
+            for (int i = 0; i < K->n; i++) v[i] /= beta;
+            KH(K, j, j - 1) = 0.0;
+        } else {
+            for (int i = 0; i < K->n; i++) v[i] = K->f[i] / beta;
+            if (j > 0) KH(K, j, j - 1) = beta;
+        }
+
+        K->matvec(K->context, v, K->f);
+        double norm = sqrt(simd_kernels.vector_dot(K->f, K->f, K->n));
+        if (norm > K->scale) K->scale = norm;
+
+        memset(K->h, 0, (j + 1) * sizeof(double));
+        orthogonalize(K, j + 1, K->f, K->h);
+        for (int i = 0; i <= j; i++) {
+            KH(K, i, j) = K->h[i];
+        }
+        if (K->symmetric) {
+            // Lanczos: H is tridiagonal; keep only the three-term recurrence
+            // and use the exact symmetric coupling.
+            for (int i = 0; i + 1 < j; i++) {
+                KH(K, i, j) = 0.0;
+            }
+            if (j > 0) KH(K, j - 1, j) = KH(K, j, j - 1);
+        }
+    }
+}
+
+// Householder QR of K->M, applying each reflector P as H <- P H P and
+// Q <- Q P. The product of the reflectors is the orthogonal factor of the
+// shift polynomial, so this is one (double-)shifted QR step on H.
+static void apply_shift_polynomial(krylov_t* K) {
+    int m = K->m;
+    double* v = K->h;
+
+    for (int j = 0; j < m - 1; j++) {
+        double norm = 0.0;
+        for (int i = j; i < m; i++) {
+            v[i] = K->M[(size_t)i * m + j];
+            norm += v[i] * v[i];
+        }
+        norm = sqrt(norm);
+        if (norm == 0.0) continue;
+        v[j] += v[j] >= 0 ? norm : -norm;
+        double vv = 0.0;
+        for (int i = j; i < m; i++) vv += v[i] * v[i];
+        double tau = 2.0 / vv;
+
+        // Left application to M and H: rows j..m-1.
+        for (int pass = 0; pass < 2; pass++) {
+            double* A = pass == 0 ? K->M : K->H;
+            for (int c = 0; c < m; c++) {
+                double s = 0.0;
+                for (int i = j; i < m; i++) s += v[i] * A[(size_t)i * m + c];
+                s *= tau;
+                for (int i = j; i < m; i++) A[(size_t)i * m + c] -= s * v[i];
+            }
+        }
+        // Right application to H and Q: columns j..m-1.
+        for (int pass = 0; pass < 2; pass++) {
+            double* A = pass == 0 ? K->H : K->Q;
+            for (int r = 0; r < m; r++) {
+                double* row = A + (size_t)r * m;
+                double s = tau * simd_kernels.vector_dot(row + j, v + j, m - j);
+                simd_kernels.vector_axpy(-s, v + j, row + j, m - j);
+            }
+        }
+    }
+}
+
+// Sets K->M = (H - shift) for a real shift, or (H - mu)(H - conj(mu)) =
+// H^2 - 2 Re(mu) H + |mu|^2 I for a complex pair.
+static void build_shift_polynomial(krylov_t* K, double re, double im) {
+    int m = K->m;
+    if (im == 0.0) {
+        memcpy(K->M, K->H, (size_t)m * m * sizeof(double));
+        for (int i = 0; i < m; i++) K->M[(size_t)i * m + i] -= re;
+        return;
+    }
+
+    memset(K->M, 0, (size_t)m * m * sizeof(double));
+    for (int i = 0; i < m; i++) {
+        for (int p = 0; p < m; p++) {
+            double a = KH(K, i, p);
+            if (a == 0.0) continue;
+            simd_kernels.vector_axpy(a, &KH(K, p, 0), K->M + (size_t)i * m, m);
+        }
+        simd_kernels.vector_axpy(-2.0 * re, &KH(K, i, 0), K->M + (size_t)i * m, m);
+        K->M[(size_t)i * m + i] += re * re + im * im;
+    }
+}
+
+// Implicit restart with the unwanted Ritz values ritz[wanted..m-1] as
+// exact shifts, leaving a wanted-step factorization ready to extend.
+static void krylov_restart(krylov_t* K, const eigen_t* ritz, int wanted) {
+    int m = K->m;
+    memset(K->Q, 0, (size_t)m * m * sizeof(double));
+    for (int i = 0; i < m; i++) K->Q[(size_t)i * m + i] = 1.0;
+
+    for (int s = wanted; s < m; s++) {
+        double im = ritz[s].eigenvalue_imag;
+        if (im < 0.0) continue;  // second half of a pair already applied
+        build_shift_polynomial(K, ritz[s].eigenvalue, im);
+        apply_shift_polynomial(K);
+    }
+
+    // Restore the exact Hessenberg (tridiagonal) shape lost to rounding.
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < i - 1; j++) KH(K, i, j) = 0.0;
+        if (K->symmetric) {
+            for (int j = i + 2; j < m; j++) KH(K, i, j) = 0.0;
+            if (i > 0) {
+                double sub = 0.5 * (KH(K, i, i - 1) + KH(K, i - 1, i));
+                KH(K, i, i - 1) = sub;
+                KH(K, i - 1, i) = sub;
+            }
+        }
+    }
+
+    // New basis rows 0..wanted are (V^T Q)^T = Q^T V.
+    int rows = wanted + 1;
+    double* Qt = K->M;
+    for (int j = 0; j < rows; j++) {
+        for (int i = 0; i < m; i++) Qt[(size_t)j * m + i] = K->Q[(size_t)i * m + j];
+    }
+    memset(K->V_next, 0, (size_t)rows * K->ld * sizeof(double));
+    gemm_compute(rows, K->n, m, 1.0, Qt, m, K->V, K->ld, K->V_next, K->ld, is_openmp_enabled());
+
+    // f+ = v+_wanted * H+[wanted][wanted-1] + f * Q[m-1][wanted-1]
+    double coupling = KH(K, wanted, wanted - 1);
+    double carry = K->Q[(size_t)(m - 1) * m + wanted - 1];
+    for (int i = 0; i < K->n; i++) {
+        K->f[i] = K->V_next[(size_t)wanted * K->ld + i] * coupling + K->f[i] * carry;
+    }
+
+    double* swap = K->V;
+    K->V = K->V_next;
+    K->V_next = swap;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < m; j++) {
+            if (i >= wanted || j >= wanted) KH(K, i, j) = 0.0;
+        }
+    }
+}
+
+static int compare_magnitude(const void* a, const void* b) {
+    const eigen_t* x = (const eigen_t*)a;
+    const eigen_t* y = (const eigen_t*)b;
+    double mx = hypot(x->eigenvalue, x->eigenvalue_imag);
+    double my = hypot(y->eigenvalue, y->eigenvalue_imag);
+    if (mx != my) return mx < my ? 1 : -1;
+    if (x->eigenvalue != y->eigenvalue) return x->eigenvalue < y->eigenvalue ? 1 : -1;
+    if (x->eigenvalue_imag != y->eigenvalue_imag) return x->eigenvalue_imag < y->eigenvalue_imag ? 1 : -1;
+    return 0;
+}
+
+// Ritz vectors V^T y for the first k Ritz pairs, normalized.
+static eigen_t* ritz_vectors(const krylov_t* K, const eigen_t* ritz, int k) {
+    eigen_t* results = (eigen_t*)calloc((size_t)k, sizeof(eigen_t));
+    if (!results) return NULL;
+
+    for (int r = 0; r < k; r++) {
+        eigen_t* pair = &results[r];
+        pair->eigenvalue = ritz[r].eigenvalue;
+        pair->eigenvalue_imag = ritz[r].eigenvalue_imag;
+        pair->eigenvector = (double*)calloc((size_t)K->n, sizeof(double));
+        if (ritz[r].eigenvector_imag) {
+            pair->eigenvector_imag = (double*)calloc((size_t)K->n, sizeof(double));
+        }
+        if (!pair->eigenvector || (ritz[r].eigenvector_imag && !pair->eigenvector_imag)) {
+            free_eigen_results(results, k);
+            return NULL;
+        }
+
+        for (int j = 0; j < K->m; j++) {
+            simd_kernels.vector_axpy(ritz[r].eigenvector[j], KV(K, j), pair->eigenvector, K->n);
+            if (pair->eigenvector_imag) {
+                simd_kernels.vector_axpy(ritz[r].eigenvector_imag[j], KV(K, j), pair->eigenvector_imag, K->n);
+            }
+        }
+
+        double norm = simd_kernels.vector_dot(pair->eigenvector, pair->eigenvector, K->n);
+        if (pair->eigenvector_imag) {
+            norm += simd_kernels.vector_dot(pair->eigenvector_imag, pair->eigenvector_imag, K->n);
+        }
+        norm = sqrt(norm);
+        if (norm > 0.0) {
+            for (int i = 0; i < K->n; i++) {
+                pair->eigenvector[i] /= norm;
+                if (pair->eigenvector_imag) pair->eigenvector_imag[i] /= norm;
+            }
+        }
+    }
+    return results;
+}
+
+static void krylov_free(krylov_t* K) {
+    free(K->V);
+    free(K->V_next);
+    free(K->H);
+    free(K->Q);
+    free(K->M);
+    free(K->f);
+    free(K->h);
+}
+
+int eigen_solve_top_k(int n, eigen_matvec_fn matvec, void* context, int symmetric,
+                      int k, eigen_t** eigenvalues, int* count) {
+    if (n <= 0 || !matvec || k <= 0) return -1;
+    if (k > n) k = n;
+
+    krylov_t K;
+    memset(&K, 0, sizeof(K));
+    K.n = n;
+    K.m = 2 * k + 1 > KRYLOV_MIN_BASIS ? 2 * k + 1 : KRYLOV_MIN_BASIS;
+    if (K.m > n) K.m = n;
+    K.ld = matrix_stride_for(n);
+    K.symmetric = symmetric;
+    K.matvec = matvec;
+    K.context = context;
+    K.seed = 12345u;
+
+    int m = K.m;
+    K.V = krylov_alloc((size_t)m * K.ld);
+    K.V_next = krylov_alloc((size_t)m * K.ld);
+    K.H = krylov_alloc((size_t)m * m);
+    K.Q = krylov_alloc((size_t)m * m);
+    K.M = krylov_alloc((size_t)m * m);
+    K.f = krylov_alloc((size_t)K.ld);
+    K.h = krylov_alloc((size_t)2 * m);
+    if (!K.V || !K.V_next || !K.H || !K.Q || !K.M || !K.f || !K.h) {
+        printf("Memory allocation failed for Krylov workspace\n");
+        krylov_free(&K);
+        return -1;
+    }
+
+    random_vector(&K, K.f);
+    krylov_extend(&K, 0);
+
+    int status = -1;
+    int max_restarts = global_config.eigen_max_iterations > 0 ? global_config.eigen_max_iterations : 1;
+    double small = pow(DBL_EPSILON, 2.0 / 3.0);
+    for (int restart = 0; restart <= max_restarts; restart++) {
+        eigen_t* ritz = NULL;
+        int ritz_count = 0;
+        if (eigen_solve_dense(K.H, m, m, symmetric, &ritz, &ritz_count) != 0) break;
+        qsort(ritz, (size_t)ritz_count, sizeof(eigen_t), compare_magnitude);
+
+        // |A x - theta x| = ||f|| * |last component of y| for Ritz pair (theta, y).
+        double beta = sqrt(simd_kernels.vector_dot(K.f, K.f, n));
+        int converged = 0;
+        for (int i = 0; i < k; i++) {
+            double last = ritz[i].eigenvector[m - 1];
+            double last_imag = ritz[i].eigenvector_imag ? ritz[i].eigenvector_imag[m - 1] : 0.0;
+            double magnitude = hypot(ritz[i].eigenvalue, ritz[i].eigenvalue_imag);
+            if (beta * hypot(last, last_imag) <= global_config.eigen_tolerance * fmax(magnitude, small)) {
+                converged++;
+            }
+        }
+
+        // Keep a few extra Ritz pairs once some have converged so the wanted
+        // ones do not stagnate (as ARPACK does), and never split a conjugate
+        // pair between the kept and discarded sets.
+        int wanted = k + (converged < (m - k) / 2 ? converged : (m - k) / 2);
+        if (wanted < m && ritz[wanted - 1].eigenvalue_imag > 0.0) wanted++;
+
+        if (converged == k || m == n || wanted >= m || restart == max_restarts) {
+            if (converged == k || m == n) {
+                *eigenvalues = ritz_vectors(&K, ritz, k);
+                if (*eigenvalues) {
+                    *count = k;
+                    status = 0;
+                }
+            } else {
+                printf("Warning: Arnoldi did not converge after %d restarts (%d of %d pairs)\n",
+                       restart, converged, k);
+            }
+            free_eigen_results(ritz, ritz_count);
+            break;
+        }
+
+        krylov_restart(&K, ritz, wanted);
+        free_eigen_results(ritz, ritz_count);
+        krylov_extend(&K, wanted);
+    }
+
+    krylov_free(&K);
+    return status;
+}
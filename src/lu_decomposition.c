@@ -0,0 +1,163 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/lu_decomposition.h"
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/trace.h"
+
+typedef struct {
+    double magnitude;
+    int row;
+} lu_pivot_t;
+
+// Larger magnitude wins; ties go to the lower row so the result does not
+// depend on how the rows were split between threads.
+static lu_pivot_t lu_pivot_pick(lu_pivot_t a, lu_pivot_t b) {
+    if (b.magnitude > a.magnitude) return b;
+    if (b.magnitude == a.magnitude && b.row < a.row) return b;
+    return a;
+}
+
+#ifdef _OPENMP
+#pragma omp declare reduction(lu_max_pivot : lu_pivot_t : omp_out = lu_pivot_pick(omp_out, omp_in)) \
+    initializer(omp_priv = (lu_pivot_t){ -1.0, -1 })
+#endif
+
+static int min_int(int a, int b) {
+    return a < b ? a : b;
+}
+
+static void swap_rows(double* a, double* b, int n) {
+    for (int c = 0; c < n; c++) {
+        double temp = a[c];
+        a[c] = b[c];
+        b[c] = temp;
+    }
+}
+
+// Factors the panel of columns k..k+nb-1 over rows k..n-1. Row swaps are
+// applied to columns k..n-1 only: earlier columns hold L entries that no
+// later step reads. Multiplies *det by the pivots and the swap signs and
+// returns -1 as soon as a pivot is numerically zero.
+static int lu_factor_panel(double* a, int n, int lda, int k, int nb, int parallel, double* det) {
+    int panel_end = k + nb;
+    int singular = 0;
+    double product = *det;
+    lu_pivot_t best;
+    (void)parallel;
+
+    #ifdef _OPENMP
+    #pragma omp parallel if(parallel && n - k >= LU_PARALLEL_MIN_ROWS)
+    #endif
+    for (int j = k; j < panel_end; j++) {
+        #ifdef _OPENMP
+        #pragma omp single
+        #endif
+        best = (lu_pivot_t){ -1.0, -1 };
+
+        #ifdef _OPENMP
+        #pragma omp for reduction(lu_max_pivot:best)
+        #endif
+        for (int i = j; i < n; i++) {
+            lu_pivot_t candidate = { fabs(a[(size_t)i * lda + j]), i };
+            best = lu_pivot_pick(best, candidate);
+        }
+
+        #ifdef _OPENMP
+        #pragma omp single
+        #endif
+        {
+            double* pivot_row = a + (size_t)j * lda;
+            if (best.row != j) {
+                swap_rows(pivot_row + k, a + (size_t)best.row * lda + k, n - k);
+                product = -product;
+            }
+            if (fabs(pivot_row[j]) < LU_SINGULAR_TOLERANCE) {
+                singular = 1;
+            } else {
+                product *= pivot_row[j];
+            }
+        }
+        if (singular) break;
+
+        const double* pivot_row = a + (size_t)j * lda;
+        double inverse = 1.0 / pivot_row[j];
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int i = j + 1; i < n; i++) {
+            double* row = a + (size_t)i * lda;
+            double factor = row[j] * inverse;
+            row[j] = factor;
+            simd_kernels.vector_axpy(-factor, pivot_row + j + 1, row + j + 1, panel_end - j - 1);
+        }
+    }
+
+    *det = singular ? 0.0 : product;
+    return singular ? -1 : 0;
+}
+
+// U12 = L11^-1 * A12 for the unit lower triangular L11 of the current panel.
+// Column chunks are independent, so they are spread over threads.
+static void lu_solve_row_block(double* a, int n, int lda, int k, int nb, int parallel) {
+    int first = k + nb;
+    int chunks = (n - first + LU_SOLVE_CHUNK - 1) / LU_SOLVE_CHUNK;
+    (void)parallel;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if(parallel && chunks > 1)
+    #endif
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        int col = first + chunk * LU_SOLVE_CHUNK;
+        int width = min_int(LU_SOLVE_CHUNK, n - col);
+        for (int i = k + 1; i < first; i++) {
+            double* row = a + (size_t)i * lda;
+            for (int p = k; p < i; p++) {
+                simd_kernels.vector_axpy(-row[p], a + (size_t)p * lda + col, row + col, width);
+            }
+        }
+    }
+}
+
+int lu_determinant_blocked(double* a, int n, int lda, int parallel,
+                           lu_update_fn update, void* context, double* det) {
+    *det = 1.0;
+
+    for (int k = 0; k < n; k += LU_BLOCK_SIZE) {
+        int nb = min_int(LU_BLOCK_SIZE, n - k);
+        long long span = trace_begin();
+        int singular = lu_factor_panel(a, n, lda, k, nb, parallel, det) != 0;
+        trace_end("lu_panel", span);
+        if (singular) {
+            return 0;
+        }
+
+        int rest = n - k - nb;
+        if (rest == 0) break;
+
+        span = trace_begin();
+        lu_solve_row_block(a, n, lda, k, nb, parallel);
+        trace_end("lu_row_solve", span);
+
+        const double* L21 = a + (size_t)(k + nb) * lda + k;
+        const double* U12 = a + (size_t)k * lda + k + nb;
+        double* A22 = a + (size_t)(k + nb) * lda + k + nb;
+        span = trace_begin();
+        int failed = 0;
+        if (update) {
+            failed = update(context, rest, rest, nb, L21, U12, A22, lda) != 0;
+        } else {
+            gemm_compute(rest, rest, nb, -1.0, L21, lda, U12, lda, A22, lda, parallel);
+        }
+        trace_end("lu_trailing_update", span);
+        if (failed) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,10 +12,14 @@
 #include "../include/matrix_operations.h"
 #include "../include/openmp_utils.h"
 #include "../include/matrix_generator.h"
+#include "../include/simd_kernels.h"
+#include "../include/dispatcher.h"
+#include "../include/perf_counters.h"
+#include "../include/trace.h"
+#include "../include/script_runner.h"
+#include "../include/server.h"
 
 extern config_t global_config;
-extern matrix_t* matrix_registry[MAX_MATRICES];
-extern int matrix_count;
 extern child_process_t process_pool[MAX_PROCESSES];
 extern int active_processes;
 
@@ -29,14 +34,10 @@ void print_banner() {
     printf("\n");
 }
 
-void initialize_system(int argc, char* argv[]) {
+void initialize_system(const char* config_path) {
     printf("Initializing system...\n");
     
-    if (argc > 1) {
-        load_config(argv[1]);
-    } else {
-        load_config(NULL);
-    }
+    load_config(config_path);
     
     printf("DEBUG: System configured with max_matrices = %d\n", global_config.max_matrices);
     
@@ -49,13 +50,22 @@ void initialize_system(int argc, char* argv[]) {
         printf("OpenMP: Disabled\n");
     }
     
-    for (int i = 0; i < MAX_MATRICES; i++) {
-        matrix_registry[i] = NULL;
-    }
+    simd_initialize((simd_level_t)global_config.simd_level);
+    printf("SIMD kernels: %s\n", simd_kernels.name);
     
+    // Workers inherit the trace rings, so tracing starts before the pool.
+    if (trace_init(global_config.trace_file) == 0 && trace_active) {
+        printf("Tracing to '%s'\n", global_config.trace_file);
+    }
     initialize_process_pool();
     setup_signal_handlers();
     
+    dispatcher_calibrate();
+    dispatcher_print_model();
+    
+    perf_counters_init();
+    perf_print_available();
+    
     printf("System initialized successfully.\n");
     printf("Matrix directory: %s\n", global_config.matrix_directory);
     printf("Process pool size: %d\n", global_config.process_pool_size);
@@ -69,13 +79,75 @@ void initialize_system(int argc, char* argv[]) {
 void cleanup_system() {
     printf("Cleaning up system...\n");
     clear_matrix_registry();
+    perf_counters_shutdown();
     cleanup_process_pool();
+    trace_flush();
     printf("System cleanup completed.\n");
 }
 
+// Headless mode: results go to the real stdout while everything the
+// library prints on the way is sent to stderr, so stdout stays parseable.
+static int run_script(const char* config_path, const char* script_path) {
+    FILE* input = strcmp(script_path, "-") == 0 ? stdin : fopen(script_path, "r");
+    if (!input) {
+        fprintf(stderr, "Cannot open script '%s'\n", script_path);
+        return 1;
+    }
+
+    fflush(stdout);
+    int results_fd = dup(STDOUT_FILENO);
+    FILE* results = results_fd >= 0 ? fdopen(results_fd, "w") : NULL;
+    if (!results) {
+        fprintf(stderr, "Cannot duplicate stdout\n");
+        return 1;
+    }
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    initialize_system(config_path);
+    pool_verbose = 0;
+    int failed = script_run(input, strcmp(script_path, "-") == 0 ? "stdin" : script_path, results);
+    cleanup_system();
+
+    if (input != stdin) fclose(input);
+    fclose(results);
+    return failed > 0 ? 1 : 0;
+}
+
+// Daemon mode: start up once, load the matrix directory, then serve
+// requests until told to stop.
+static int run_server(const char* config_path, const char* socket_path) {
+    print_banner();
+    initialize_system(config_path);
+    int loaded_count = load_matrix_directory();
+    printf("Loaded %d matrices from '%s'\n", loaded_count, global_config.matrix_directory);
+    pool_verbose = 0;
+    int status = server_run(socket_path);
+    cleanup_system();
+    return status == 0 ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
+    const char* config_path = NULL;
+    const char* script_path = NULL;
+    const char* socket_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script_path = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else {
+            config_path = argv[i];
+        }
+    }
+    if (script_path) {
+        return run_script(config_path, script_path);
+    }
+    if (socket_path) {
+        return run_server(config_path, socket_path);
+    }
+
     print_banner();
-    initialize_system(argc, argv);
+    initialize_system(config_path);
     
     int loaded_count = load_matrix_directory();
     if (loaded_count > 0) {
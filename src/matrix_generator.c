@@ -7,6 +7,7 @@
 #include "../include/matrix_operations.h"
 #include "../include/config.h"
 #include "../include/matrix_generator.h"
+#include "../include/file_operations.h"
 
 void generate_random_matrices(int count, int min_size, int max_size) {
     if (count <= 0) {
@@ -67,19 +68,8 @@ void generate_random_matrices(int count, int min_size, int max_size) {
                     global_config.matrix_directory, i+1);
         }
         
-        FILE* file = fopen(filename, "w");
-        if (file) {
-            fprintf(file, "# Random Matrix %dx%d\n", rows, cols);
-            fprintf(file, "# Generated automatically\n");
-            for (int r = 0; r < rows; r++) {
-                for (int c = 0; c < cols; c++) {
-                    fprintf(file, "%.2f ", matrix->data[r][c]);
-                }
-                fprintf(file, "\n");
-            }
-            fclose(file);
-            
-            if (matrix_count < global_config.max_matrices) {
+        if (write_matrix_text(matrix, filename) == 0) {
+            if (global_config.max_matrices <= 0 || matrix_count < global_config.max_matrices) {
                 if (add_matrix_to_registry(matrix) >= 0) {
                     generated++;
                     printf("✓ Generated: %s (%dx%d)\n", matrix_name, rows, cols);
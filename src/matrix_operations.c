@@ -1,22 +1,35 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <sys/mman.h>
 #include "../include/matrix_operations.h"
 #include "../include/config.h"
-
-matrix_t* matrix_registry[MAX_MATRICES];
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/lu_decomposition.h"
+#include "../include/eigen_solver.h"
+#include "../include/krylov_eigen.h"
+#include "../include/result_cache.h"
+
+matrix_t** matrix_registry = NULL;
+int matrix_registry_capacity = 0;
 int matrix_count = 0;
 int next_matrix_id = 1;
+// Never reset, so (id, version) stays unique even after the registry is cleared.
+static unsigned long next_matrix_version = 1;
 
-matrix_t* create_matrix(int rows, int cols, const char* name) {
-    if (rows <= 0 || cols <= 0 || rows > MAX_MATRIX_SIZE || cols > MAX_MATRIX_SIZE) {
-        printf("Invalid matrix dimensions: %dx%d\n", rows, cols);
-        return NULL;
-    }
-    
-    matrix_t* matrix = (matrix_t*)malloc(sizeof(matrix_t));
+int matrix_stride_for(int cols) {
+    int per_line = MATRIX_ALIGNMENT / (int)sizeof(double);
+    return (cols + per_line - 1) / per_line * per_line;
+}
+
+static matrix_t* alloc_matrix_header(int rows, int cols, const char* name) {
+    // Header and row-pointer view share one allocation; elements live in a
+    // single aligned buffer so kernels can walk memory linearly.
+    matrix_t* matrix = (matrix_t*)malloc(sizeof(matrix_t) + (size_t)rows * sizeof(double*));
     if (!matrix) {
         printf("Memory allocation failed for matrix structure\n");
         return NULL;
@@ -24,57 +37,110 @@ matrix_t* create_matrix(int rows, int cols, const char* name) {
     
     matrix->rows = rows;
     matrix->cols = cols;
-    matrix->id = next_matrix_id++;
+    // Matrices may be created on loader threads; they get their final IDs
+    // when registered, but the counter must not tear meanwhile.
+    int id;
+    #ifdef _OPENMP
+    #pragma omp atomic capture
+    #endif
+    id = next_matrix_id++;
+    matrix->id = id;
+    unsigned long version;
+    #ifdef _OPENMP
+    #pragma omp atomic capture
+    #endif
+    version = next_matrix_version++;
+    matrix->version = version;
     strncpy(matrix->name, name, sizeof(matrix->name) - 1);
     matrix->name[sizeof(matrix->name) - 1] = '\0';
+    matrix->stride = matrix_stride_for(cols);
+    matrix->storage = NULL;
+    matrix->mapped_length = 0;
+    matrix->data = (double**)(matrix + 1);
+    return matrix;
+}
+
+static void bind_row_views(matrix_t* matrix) {
+    for (int i = 0; i < matrix->rows; i++) {
+        matrix->data[i] = MATRIX_ROW(matrix, i);
+    }
+}
+
+matrix_t* create_matrix(int rows, int cols, const char* name) {
+    if (rows <= 0 || cols <= 0 || rows > MATRIX_MAX_DIMENSION || cols > MATRIX_MAX_DIMENSION) {
+        printf("Invalid matrix dimensions: %dx%d\n", rows, cols);
+        return NULL;
+    }
+    
+    matrix_t* matrix = alloc_matrix_header(rows, cols, name);
+    if (!matrix) return NULL;
     
-    matrix->data = (double**)malloc(rows * sizeof(double*));
-    if (!matrix->data) {
-        printf("Memory allocation failed for matrix rows\n");
+    size_t bytes = (size_t)rows * matrix->stride * sizeof(double);
+    void* storage = NULL;
+    if (posix_memalign(&storage, MATRIX_ALIGNMENT, bytes) != 0) {
+        printf("Memory allocation failed for matrix data (%dx%d, %.1f MB)\n",
+               rows, cols, (double)bytes / (1024.0 * 1024.0));
         free(matrix);
         return NULL;
     }
+    memset(storage, 0, bytes);
     
-    for (int i = 0; i < rows; i++) {
-        matrix->data[i] = (double*)malloc(cols * sizeof(double));
-        if (!matrix->data[i]) {
-            printf("Memory allocation failed for matrix columns\n");
-            for (int j = 0; j < i; j++) {
-                free(matrix->data[j]);
-            }
-            free(matrix->data);
-            free(matrix);
-            return NULL;
-        }
-        memset(matrix->data[i], 0, cols * sizeof(double));
+    matrix->storage = (double*)storage;
+    bind_row_views(matrix);
+    return matrix;
+}
+
+// Wraps an existing mmap()ed region (e.g. a shared-memory result written by
+// pool workers) as matrix storage. The matrix takes ownership and unmaps
+// mapped_length bytes from storage when freed.
+matrix_t* create_matrix_on_mapping(int rows, int cols, const char* name,
+                                   double* storage, int stride, size_t mapped_length) {
+    if (rows <= 0 || cols <= 0 || !storage || stride < cols ||
+        rows > MATRIX_MAX_DIMENSION || stride > MATRIX_MAX_DIMENSION) {
+        printf("Invalid matrix mapping: %dx%d\n", rows, cols);
+        return NULL;
     }
     
+    matrix_t* matrix = alloc_matrix_header(rows, cols, name);
+    if (!matrix) return NULL;
+    
+    matrix->stride = stride;
+    matrix->storage = storage;
+    matrix->mapped_length = mapped_length;
+    bind_row_views(matrix);
     return matrix;
 }
 
 void free_matrix(matrix_t* matrix) {
     if (!matrix) return;
     
-    if (matrix->data) {
-        for (int i = 0; i < matrix->rows; i++) {
-            if (matrix->data[i]) {
-                free(matrix->data[i]);
-            }
-        }
-        free(matrix->data);
+    if (matrix->mapped_length) {
+        munmap(matrix->storage, matrix->mapped_length);
+    } else {
+        free(matrix->storage);
     }
     free(matrix);
 }
 
+// Called after editing a matrix in place so cached results computed from
+// its old contents are no longer used.
+void matrix_mark_modified(matrix_t* matrix) {
+    matrix->version = next_matrix_version++;
+    result_cache_invalidate(matrix->id);
+}
+
 matrix_t* copy_matrix(const matrix_t* original) {
     if (!original) return NULL;
     
     matrix_t* copy = create_matrix(original->rows, original->cols, original->name);
     if (!copy) return NULL;
     
-    for (int i = 0; i < original->rows; i++) {
-        for (int j = 0; j < original->cols; j++) {
-            copy->data[i][j] = original->data[i][j];
+    if (copy->stride == original->stride) {
+        memcpy(copy->storage, original->storage,
+               (size_t)original->rows * original->stride * sizeof(double));
+    } else {
+        for (int i = 0; i < original->rows; i++) {
+            memcpy(MATRIX_ROW(copy, i), MATRIX_ROW(original, i), original->cols * sizeof(double));
         }
     }
     
@@ -111,9 +177,7 @@ matrix_t* add_matrices_seq(const matrix_t* A, const matrix_t* B) {
     if (!result) return NULL;
     
     for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            result->data[i][j] = A->data[i][j] + B->data[i][j];
-        }
+        simd_kernels.vector_add(MATRIX_ROW(A, i), MATRIX_ROW(B, i), MATRIX_ROW(result, i), A->cols);
     }
     
     return result;
@@ -135,9 +199,7 @@ matrix_t* subtract_matrices_seq(const matrix_t* A, const matrix_t* B) {
     if (!result) return NULL;
     
     for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            result->data[i][j] = A->data[i][j] - B->data[i][j];
-        }
+        simd_kernels.vector_sub(MATRIX_ROW(A, i), MATRIX_ROW(B, i), MATRIX_ROW(result, i), A->cols);
     }
     
     return result;
@@ -158,14 +220,9 @@ matrix_t* multiply_matrices_seq(const matrix_t* A, const matrix_t* B) {
     matrix_t* result = create_matrix(A->rows, B->cols, "Multiplication_Result");
     if (!result) return NULL;
     
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < B->cols; j++) {
-            result->data[i][j] = 0.0;
-            for (int k = 0; k < A->cols; k++) {
-                result->data[i][j] += A->data[i][k] * B->data[k][j];
-            }
-        }
-    }
+    gemm_compute(A->rows, B->cols, A->cols, 1.0,
+                 A->storage, A->stride, B->storage, B->stride,
+                 result->storage, result->stride, 0);
     
     return result;
 }
@@ -182,12 +239,10 @@ matrix_t* add_matrices_openmp(const matrix_t* A, const matrix_t* B) {
     if (!result) return NULL;
     
     #ifdef _OPENMP
-    #pragma omp parallel for collapse(2)
+    #pragma omp parallel for
     #endif
     for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            result->data[i][j] = A->data[i][j] + B->data[i][j];
-        }
+        simd_kernels.vector_add(MATRIX_ROW(A, i), MATRIX_ROW(B, i), MATRIX_ROW(result, i), A->cols);
     }
     
     return result;
@@ -205,12 +260,10 @@ matrix_t* subtract_matrices_openmp(const matrix_t* A, const matrix_t* B) {
     if (!result) return NULL;
     
     #ifdef _OPENMP
-    #pragma omp parallel for collapse(2)
+    #pragma omp parallel for
     #endif
     for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            result->data[i][j] = A->data[i][j] - B->data[i][j];
-        }
+        simd_kernels.vector_sub(MATRIX_ROW(A, i), MATRIX_ROW(B, i), MATRIX_ROW(result, i), A->cols);
     }
     
     return result;
@@ -227,23 +280,27 @@ matrix_t* multiply_matrices_openmp(const matrix_t* A, const matrix_t* B) {
     matrix_t* result = create_matrix(A->rows, B->cols, "Multiplication_Result_OpenMP");
     if (!result) return NULL;
     
-    #ifdef _OPENMP
-    #pragma omp parallel for collapse(2)
-    #endif
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < B->cols; j++) {
-            result->data[i][j] = 0.0;
-            for (int k = 0; k < A->cols; k++) {
-                result->data[i][j] += A->data[i][k] * B->data[k][j];
-            }
-        }
-    }
+    gemm_compute(A->rows, B->cols, A->cols, 1.0,
+                 A->storage, A->stride, B->storage, B->stride,
+                 result->storage, result->stride, 1);
     
     return result;
 }
 
 
 
+// Runs the blocked LU on a private copy; parallel spreads the panel, the
+// triangular solve and the trailing GEMM over OpenMP threads.
+static double determinant_blocked(const matrix_t* matrix, int parallel) {
+    matrix_t* LU = copy_matrix(matrix);
+    if (!LU) return 0.0;
+    
+    double det = 0.0;
+    lu_determinant_blocked(LU->storage, LU->rows, LU->stride, parallel, NULL, NULL, &det);
+    free_matrix(LU);
+    return det;
+}
+
 double matrix_determinant_lu(const matrix_t* matrix) {
     if (!matrix || matrix->rows == 0 || matrix->cols == 0) {
         printf("Error: Matrix is empty or invalid.\n");
@@ -272,55 +329,7 @@ double matrix_determinant_lu(const matrix_t* matrix) {
                matrix->data[0][2] * (matrix->data[1][0] * matrix->data[2][1] - matrix->data[1][1] * matrix->data[2][0]);
     }
     
-    matrix_t* LU = copy_matrix(matrix);
-    if (!LU) return 0.0;
-    
-    double det = 1.0;
-    int* pivot = (int*)malloc(n * sizeof(int));
-    
-    for (int i = 0; i < n; i++) {
-        pivot[i] = i;
-    }
-    
-    for (int j = 0; j < n; j++) {
-        int max_row = j;
-        for (int i = j + 1; i < n; i++) {
-            if (fabs(LU->data[i][j]) > fabs(LU->data[max_row][j])) {
-                max_row = i;
-            }
-        }
-        
-        if (max_row != j) {
-            for (int k = 0; k < n; k++) {
-                double temp = LU->data[j][k];
-                LU->data[j][k] = LU->data[max_row][k];
-                LU->data[max_row][k] = temp;
-            }
-            int temp_pivot = pivot[j];
-            pivot[j] = pivot[max_row];
-            pivot[max_row] = temp_pivot;
-            det *= -1;
-        }
-        
-        if (fabs(LU->data[j][j]) < 1e-12) {
-            free_matrix(LU);
-            free(pivot);
-            return 0.0;
-        }
-        
-        det *= LU->data[j][j];
-        
-        for (int i = j + 1; i < n; i++) {
-            LU->data[i][j] /= LU->data[j][j];
-            for (int k = j + 1; k < n; k++) {
-                LU->data[i][k] -= LU->data[i][j] * LU->data[j][k];
-            }
-        }
-    }
-    
-    free_matrix(LU);
-    free(pivot);
-    return det;
+    return determinant_blocked(matrix, 0);
 }
 
 double matrix_determinant_seq(const matrix_t* matrix) {
@@ -333,14 +342,9 @@ matrix_t* matrix_multiply(const matrix_t* A, const matrix_t* B) {
     matrix_t* result = create_matrix(A->rows, B->cols, "temp");
     if (!result) return NULL;
     
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < B->cols; j++) {
-            result->data[i][j] = 0.0;
-            for (int k = 0; k < A->cols; k++) {
-                result->data[i][j] += A->data[i][k] * B->data[k][j];
-            }
-        }
-    }
+    gemm_compute(A->rows, B->cols, A->cols, 1.0,
+                 A->storage, A->stride, B->storage, B->stride,
+                 result->storage, result->stride, 0);
     return result;
 }
 
@@ -359,11 +363,7 @@ matrix_t* matrix_transpose(const matrix_t* A) {
 }
 
 double vector_dot_product(const double* v1, const double* v2, int n) {
-    double result = 0.0;
-    for (int i = 0; i < n; i++) {
-        result += v1[i] * v2[i];
-    }
-    return result;
+    return simd_kernels.vector_dot(v1, v2, n);
 }
 
 double vector_norm(const double* v, int n) {
@@ -431,91 +431,59 @@ int find_dominant_eigenvalue(const matrix_t* matrix, double* eigenvalue, double*
     return converged ? 0 : -1;
 }
 
-int find_eigenvalues_2x2(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
-    if (matrix->rows != 2) return -1;
-    
-    *eigenvalues = (eigen_t*)malloc(2 * sizeof(eigen_t));
-    (*eigenvalues)[0].eigenvector = (double*)malloc(2 * sizeof(double));
-    (*eigenvalues)[1].eigenvector = (double*)malloc(2 * sizeof(double));
-    
-    double a = matrix->data[0][0], b = matrix->data[0][1];
-    double c = matrix->data[1][0], d = matrix->data[1][1];
-    
-    double trace = a + d;
-    double det = a * d - b * c;
-    double discriminant = trace * trace - 4 * det;
-    
-    if (discriminant >= 0) {
-        double sqrt_disc = sqrt(discriminant);
-        (*eigenvalues)[0].eigenvalue = (trace + sqrt_disc) / 2.0;
-        (*eigenvalues)[1].eigenvalue = (trace - sqrt_disc) / 2.0;
-        
-        if (fabs(b) > 1e-10) {
-            (*eigenvalues)[0].eigenvector[0] = (*eigenvalues)[0].eigenvalue - d;
-            (*eigenvalues)[0].eigenvector[1] = c;
-            (*eigenvalues)[1].eigenvector[0] = (*eigenvalues)[1].eigenvalue - d;
-            (*eigenvalues)[1].eigenvector[1] = c;
-        } else if (fabs(c) > 1e-10) {
-            (*eigenvalues)[0].eigenvector[0] = b;
-            (*eigenvalues)[0].eigenvector[1] = (*eigenvalues)[0].eigenvalue - a;
-            (*eigenvalues)[1].eigenvector[0] = b;
-            (*eigenvalues)[1].eigenvector[1] = (*eigenvalues)[1].eigenvalue - a;
-        } else {
-            (*eigenvalues)[0].eigenvector[0] = 1.0;
-            (*eigenvalues)[0].eigenvector[1] = 0.0;
-            (*eigenvalues)[1].eigenvector[0] = 0.0;
-            (*eigenvalues)[1].eigenvector[1] = 1.0;
-        }
-        
-        vector_normalize((*eigenvalues)[0].eigenvector, 2);
-        vector_normalize((*eigenvalues)[1].eigenvector, 2);
-    } else {
-        (*eigenvalues)[0].eigenvalue = trace / 2.0;
-        (*eigenvalues)[1].eigenvalue = trace / 2.0;
-        (*eigenvalues)[0].eigenvector[0] = 1.0;
-        (*eigenvalues)[0].eigenvector[1] = 0.0;
-        (*eigenvalues)[1].eigenvector[0] = 0.0;
-        (*eigenvalues)[1].eigenvector[1] = 1.0;
-    }
-    
-    *count = 2;
-    return 0;
-}
-
 int find_eigenvalues_qr(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
     if (!matrix || matrix->rows != matrix->cols) return -1;
     
-    int n = matrix->rows;
-    
-    if (n == 1) {
-        *eigenvalues = (eigen_t*)malloc(sizeof(eigen_t));
+    if (matrix->rows == 1) {
+        *eigenvalues = (eigen_t*)calloc(1, sizeof(eigen_t));
         (*eigenvalues)[0].eigenvector = (double*)malloc(sizeof(double));
         (*eigenvalues)[0].eigenvalue = matrix->data[0][0];
         (*eigenvalues)[0].eigenvector[0] = 1.0;
         *count = 1;
         return 0;
     }
-    else if (n == 2) {
-        return find_eigenvalues_2x2(matrix, eigenvalues, count);
-    }
-    else {
-        printf("Matrix size %dx%d - Using Power Method for dominant eigenvalue\n", n, n);
-        *eigenvalues = (eigen_t*)malloc(sizeof(eigen_t));
-        (*eigenvalues)[0].eigenvector = (double*)malloc(n * sizeof(double));
-        
-        if (find_dominant_eigenvalue(matrix, &(*eigenvalues)[0].eigenvalue, 
-                                   (*eigenvalues)[0].eigenvector) == 0) {
-            *count = 1;
-            return 0;
-        } else {
-            free((*eigenvalues)[0].eigenvector);
-            free(*eigenvalues);
-            return -1;
-        }
-    }
+    
+    return eigen_solve_general(matrix, eigenvalues, count);
 }
 
 int find_eigenvalues_eigenvectors(const matrix_t* matrix, eigen_t** eigenvalues, int* count) {
+    const char* solver;
+    int result = find_eigenvalues_auto(matrix, 0, eigenvalues, count, &solver);
+    printf("Solved with %s\n", solver);
+    return result;
+}
+
+// y = A x for the Krylov solver, one dot product per row.
+static void matrix_matvec(void* context, const double* x, double* y) {
+    const matrix_t* matrix = (const matrix_t*)context;
+    int n = matrix->cols;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if(is_openmp_enabled() && matrix->rows >= EIGEN_PARALLEL_MIN_ROWS)
+    #endif
+    for (int i = 0; i < matrix->rows; i++) {
+        y[i] = simd_kernels.vector_dot(MATRIX_ROW(matrix, i), x, n);
+    }
+}
+
+int find_top_eigenvalues(const matrix_t* matrix, int k, eigen_t** eigenvalues, int* count) {
+    if (!matrix || matrix->rows != matrix->cols || k <= 0) return -1;
+    return eigen_solve_top_k(matrix->rows, matrix_matvec, (void*)matrix,
+                             eigen_matrix_is_symmetric(matrix), k, eigenvalues, count);
+}
+
+int find_eigenvalues_auto(const matrix_t* matrix, int k, eigen_t** eigenvalues, int* count,
+                          const char** solver) {
+    const char* unused;
+    if (!solver) solver = &unused;
+    if (k > 0) {
+        *solver = "Krylov";
+        return find_top_eigenvalues(matrix, k, eigenvalues, count);
+    }
+    if (matrix && matrix->rows > 1 && eigen_matrix_is_symmetric(matrix)) {
+        *solver = "tridiagonal QL";
+        return eigen_solve_symmetric_ql(matrix, eigenvalues, count);
+    }
+    *solver = "Francis QR";
     return find_eigenvalues_qr(matrix, eigenvalues, count);
 }
 
@@ -546,9 +514,8 @@ void free_eigen_results(eigen_t* eigenvalues, int count) {
     if (!eigenvalues) return;
     
     for (int i = 0; i < count; i++) {
-        if (eigenvalues[i].eigenvector) {
-            free(eigenvalues[i].eigenvector);
-        }
+        free(eigenvalues[i].eigenvector);
+        free(eigenvalues[i].eigenvector_imag);
     }
     free(eigenvalues);
 }
@@ -557,10 +524,19 @@ void display_eigen_results(const eigen_t* eigenvalues, int count, int matrix_siz
     printf("\n=== EIGENVALUES & EIGENVECTORS ===\n");
     
     for (int i = 0; i < count; i++) {
-        printf("Eigenvalue %d: %.6f\n", i + 1, eigenvalues[i].eigenvalue);
+        const eigen_t* pair = &eigenvalues[i];
+        if (pair->eigenvalue_imag != 0.0) {
+            printf("Eigenvalue %d: %.6f %+.6fi\n", i + 1, pair->eigenvalue, pair->eigenvalue_imag);
+        } else {
+            printf("Eigenvalue %d: %.6f\n", i + 1, pair->eigenvalue);
+        }
         printf("Eigenvector %d: [", i + 1);
         for (int j = 0; j < matrix_size; j++) {
-            printf("%.4f", eigenvalues[i].eigenvector[j]);
+            if (pair->eigenvector_imag) {
+                printf("%.4f%+.4fi", pair->eigenvector[j], pair->eigenvector_imag[j]);
+            } else {
+                printf("%.4f", pair->eigenvector[j]);
+            }
             if (j < matrix_size - 1) printf(", ");
         }
         printf("]\n\n");
@@ -568,45 +544,177 @@ void display_eigen_results(const eigen_t* eigenvalues, int count, int matrix_siz
     printf("===================================\n");
 }
 
+// Registry index. Slots live in matrix_registry; free slots form a stack,
+// and two chained hash tables map IDs and names to slots. Chains are
+// threaded through id_next / name_next, one entry per slot, and the bucket
+// arrays double whenever the load factor would pass one. slot_added
+// records when each slot was filled, since chain order is lost when the
+// buckets are rebuilt.
+static int* registry_free_slots = NULL;
+static int registry_free_count = 0;
+static int* id_next = NULL;
+static int* name_next = NULL;
+static unsigned long* slot_added = NULL;
+static unsigned long registry_additions = 0;
+static int* id_buckets = NULL;
+static int* name_buckets = NULL;
+static int bucket_count = 0;
+
+static unsigned hash_id(int id) {
+    return ((unsigned)id * 2654435761u) & (unsigned)(bucket_count - 1);
+}
+
+static unsigned hash_name(const char* name) {
+    unsigned hash = 2166136261u;
+    for (; *name; name++) {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    return hash & (unsigned)(bucket_count - 1);
+}
+
+static void index_slot(int slot) {
+    unsigned id_bucket = hash_id(matrix_registry[slot]->id);
+    unsigned name_bucket = hash_name(matrix_registry[slot]->name);
+    id_next[slot] = id_buckets[id_bucket];
+    id_buckets[id_bucket] = slot;
+    name_next[slot] = name_buckets[name_bucket];
+    name_buckets[name_bucket] = slot;
+}
+
+static void unlink_slot(int* head, int* next, int slot) {
+    while (*head != slot) head = &next[*head];
+    *head = next[slot];
+}
+
+static int grow_buckets(void) {
+    int count = bucket_count ? bucket_count * 2 : MATRIX_REGISTRY_INITIAL_CAPACITY;
+    int* ids = (int*)malloc((size_t)count * sizeof(int));
+    int* names = (int*)malloc((size_t)count * sizeof(int));
+    if (!ids || !names) {
+        free(ids);
+        free(names);
+        return -1;
+    }
+    free(id_buckets);
+    free(name_buckets);
+    id_buckets = ids;
+    name_buckets = names;
+    bucket_count = count;
+    for (int b = 0; b < count; b++) {
+        id_buckets[b] = -1;
+        name_buckets[b] = -1;
+    }
+    for (int slot = 0; slot < matrix_registry_capacity; slot++) {
+        if (matrix_registry[slot]) index_slot(slot);
+    }
+    return 0;
+}
+
+static int grow_slots(void) {
+    int capacity = matrix_registry_capacity ? matrix_registry_capacity * 2 : MATRIX_REGISTRY_INITIAL_CAPACITY;
+    matrix_t** slots = (matrix_t**)realloc(matrix_registry, (size_t)capacity * sizeof(matrix_t*));
+    if (!slots) return -1;
+    matrix_registry = slots;
+    int* free_slots = (int*)realloc(registry_free_slots, (size_t)capacity * sizeof(int));
+    if (free_slots) registry_free_slots = free_slots;
+    int* ids = (int*)realloc(id_next, (size_t)capacity * sizeof(int));
+    if (ids) id_next = ids;
+    int* names = (int*)realloc(name_next, (size_t)capacity * sizeof(int));
+    if (names) name_next = names;
+    unsigned long* added = (unsigned long*)realloc(slot_added, (size_t)capacity * sizeof(unsigned long));
+    if (added) slot_added = added;
+    if (!free_slots || !ids || !names || !added) return -1;
+
+    // Push the new slots so the lowest index is handed out first.
+    for (int slot = capacity - 1; slot >= matrix_registry_capacity; slot--) {
+        matrix_registry[slot] = NULL;
+        registry_free_slots[registry_free_count++] = slot;
+    }
+    matrix_registry_capacity = capacity;
+    return 0;
+}
+
+static int slot_of_id(int matrix_id) {
+    if (bucket_count == 0) return -1;
+    int slot = id_buckets[hash_id(matrix_id)];
+    while (slot >= 0 && matrix_registry[slot]->id != matrix_id) slot = id_next[slot];
+    return slot;
+}
+
 int add_matrix_to_registry(matrix_t* matrix) {
     if (!matrix) return -1;
     
-    if (matrix_count >= global_config.max_matrices) {
+    if (global_config.max_matrices > 0 && matrix_count >= global_config.max_matrices) {
         printf("Matrix registry full! Cannot add more matrices.\n");
         return -1;
     }
     
-    for (int i = 0; i < MAX_MATRICES; i++) {
-        if (matrix_registry[i] == NULL) {
-            matrix_registry[i] = matrix;
-            matrix_count++;
-            return matrix->id;
-        }
+    if ((registry_free_count == 0 && grow_slots() != 0) ||
+        (matrix_count + 1 > bucket_count && grow_buckets() != 0)) {
+        printf("Memory allocation failed for matrix registry\n");
+        return -1;
     }
     
-    return -1;
+    int slot = registry_free_slots[--registry_free_count];
+    matrix_registry[slot] = matrix;
+    slot_added[slot] = ++registry_additions;
+    index_slot(slot);
+    matrix_count++;
+    return matrix->id;
 }
 
 void remove_matrix_from_registry(int matrix_id) {
-    for (int i = 0; i < MAX_MATRICES; i++) {
-        if (matrix_registry[i] && matrix_registry[i]->id == matrix_id) {
-            printf("Deleting matrix: %s (ID: %d)\n", matrix_registry[i]->name, matrix_id);
-            free_matrix(matrix_registry[i]);
-            matrix_registry[i] = NULL;
-            matrix_count--;
-            return;
-        }
+    matrix_t* matrix = find_matrix_by_id(matrix_id);
+    if (!matrix) {
+        printf("Matrix with ID %d not found in registry\n", matrix_id);
+        return;
     }
-    printf("Matrix with ID %d not found in registry\n", matrix_id);
+    
+    printf("Deleting matrix: %s (ID: %d)\n", matrix->name, matrix_id);
+    release_matrix(matrix_id);
+}
+
+int release_matrix(int matrix_id) {
+    int slot = slot_of_id(matrix_id);
+    if (slot < 0) return -1;
+    
+    matrix_t* matrix = matrix_registry[slot];
+    unlink_slot(&id_buckets[hash_id(matrix->id)], id_next, slot);
+    unlink_slot(&name_buckets[hash_name(matrix->name)], name_next, slot);
+    result_cache_invalidate(matrix_id);
+    free_matrix(matrix);
+    matrix_registry[slot] = NULL;
+    registry_free_slots[registry_free_count++] = slot;
+    matrix_count--;
+    return 0;
 }
 
 matrix_t* find_matrix_by_id(int matrix_id) {
-    for (int i = 0; i < MAX_MATRICES; i++) {
-        if (matrix_registry[i] && matrix_registry[i]->id == matrix_id) {
-            return matrix_registry[i];
+    int slot = slot_of_id(matrix_id);
+    return slot >= 0 ? matrix_registry[slot] : NULL;
+}
+
+// Names need not be unique; the most recently added match wins.
+matrix_t* find_matrix_by_name(const char* name) {
+    if (!name || bucket_count == 0) return NULL;
+    int newest = -1;
+    for (int slot = name_buckets[hash_name(name)]; slot >= 0; slot = name_next[slot]) {
+        if (strcmp(matrix_registry[slot]->name, name) == 0 &&
+            (newest < 0 || slot_added[slot] > slot_added[newest])) {
+            newest = slot;
         }
     }
-    return NULL;
+    return newest >= 0 ? matrix_registry[newest] : NULL;
+}
+
+// Index of the j-th shown row or column out of count, or -1 for the gap
+// that stands in for the middle of a large matrix.
+static int display_index(int j, int count) {
+    if (count <= 2 * MATRIX_DISPLAY_EDGE) return j;
+    if (j < MATRIX_DISPLAY_EDGE) return j;
+    if (j == MATRIX_DISPLAY_EDGE) return -1;
+    return count - (2 * MATRIX_DISPLAY_EDGE + 1 - j);
 }
 
 void display_matrix(const matrix_t* matrix) {
@@ -615,21 +723,30 @@ void display_matrix(const matrix_t* matrix) {
         return;
     }
     
+    int shown_rows = matrix->rows > 2 * MATRIX_DISPLAY_EDGE ? 2 * MATRIX_DISPLAY_EDGE + 1 : matrix->rows;
+    int shown_cols = matrix->cols > 2 * MATRIX_DISPLAY_EDGE ? 2 * MATRIX_DISPLAY_EDGE + 1 : matrix->cols;
+    
     printf("\nMatrix: %s (ID: %d, %dx%d)\n", matrix->name, matrix->id, matrix->rows, matrix->cols);
     printf("┌");
-    for (int j = 0; j < matrix->cols; j++) printf("──────────");
+    for (int j = 0; j < shown_cols; j++) printf("──────────");
     printf("┐\n");
     
-    for (int i = 0; i < matrix->rows; i++) {
+    for (int r = 0; r < shown_rows; r++) {
+        int i = display_index(r, matrix->rows);
         printf("│");
-        for (int j = 0; j < matrix->cols; j++) {
-            printf(" %8.2f ", matrix->data[i][j]);
+        for (int c = 0; c < shown_cols; c++) {
+            int j = display_index(c, matrix->cols);
+            if (i < 0 || j < 0) {
+                printf(" %8s ", "...");
+            } else {
+                printf(" %8.2f ", matrix->data[i][j]);
+            }
         }
         printf("│\n");
     }
     
     printf("└");
-    for (int j = 0; j < matrix->cols; j++) printf("──────────");
+    for (int j = 0; j < shown_cols; j++) printf("──────────");
     printf("┘\n");
 }
 
@@ -640,7 +757,7 @@ void display_all_matrices() {
     }
     
     printf("\n=== MATRIX REGISTRY (%d matrices) ===\n", matrix_count);
-    for (int i = 0; i < MAX_MATRICES; i++) {
+    for (int i = 0; i < matrix_registry_capacity; i++) {
         if (matrix_registry[i]) {
             printf("ID: %2d | %-20s | %2dx%-2d\n", 
                    matrix_registry[i]->id, 
@@ -654,22 +771,48 @@ void display_all_matrices() {
 
 void clear_matrix_registry() {
     printf("Clearing matrix registry...\n");
-    for (int i = 0; i < MAX_MATRICES; i++) {
+    result_cache_clear();
+    for (int i = 0; i < matrix_registry_capacity; i++) {
         if (matrix_registry[i]) {
             free_matrix(matrix_registry[i]);
             matrix_registry[i] = NULL;
         }
     }
+    free(matrix_registry);
+    free(registry_free_slots);
+    free(id_next);
+    free(name_next);
+    free(slot_added);
+    free(id_buckets);
+    free(name_buckets);
+    matrix_registry = NULL;
+    registry_free_slots = NULL;
+    id_next = NULL;
+    name_next = NULL;
+    slot_added = NULL;
+    id_buckets = NULL;
+    name_buckets = NULL;
+    matrix_registry_capacity = 0;
+    registry_free_count = 0;
+    bucket_count = 0;
     matrix_count = 0;
     next_matrix_id = 1;
 }
 
+// Wall-clock seconds from CLOCK_MONOTONIC. Unlike clock(), this counts
+// time spent waiting on pool workers and is not inflated by OpenMP threads.
+double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
 void start_timer(performance_timer_t* timer) {
-    timer->start_time = (double)clock() / CLOCKS_PER_SEC;
+    timer->start_time = monotonic_seconds();
 }
 
 void stop_timer(performance_timer_t* timer) {
-    timer->end_time = (double)clock() / CLOCKS_PER_SEC;
+    timer->end_time = monotonic_seconds();
 }
 
 double get_elapsed_time(const performance_timer_t* timer) {
@@ -734,86 +877,5 @@ double matrix_determinant_openmp(const matrix_t* matrix) {
     }
     
 
-    matrix_t* LU = copy_matrix(matrix);
-    if (!LU) return 0.0;
-    
-    double det = 1.0;
-    int* pivot = (int*)malloc(n * sizeof(int));
-    if (!pivot) {
-        free_matrix(LU);
-        return 0.0;
-    }
-    
-
-    for (int i = 0; i < n; i++) {
-        pivot[i] = i;
-    }
-    
-
-    for (int j = 0; j < n; j++) {
-        int max_row = j;
-        
-        // Find pivot row with maximum element in current column
-        #ifdef _OPENMP
-        #pragma omp parallel for if(is_openmp_enabled())
-        #endif
-        for (int i = j + 1; i < n; i++) {
-            if (fabs(LU->data[i][j]) > fabs(LU->data[max_row][j])) {
-                #ifdef _OPENMP
-                #pragma omp critical
-                #endif
-                {
-                    if (fabs(LU->data[i][j]) > fabs(LU->data[max_row][j])) {
-                        max_row = i;
-                    }
-                }
-            }
-        }
-        
-        // Swap rows if necessary
-        if (max_row != j) {
-            // Swap rows in parallel
-            #ifdef _OPENMP
-            #pragma omp parallel for if(is_openmp_enabled())
-            #endif
-            for (int k = 0; k < n; k++) {
-                double temp = LU->data[j][k];
-                LU->data[j][k] = LU->data[max_row][k];
-                LU->data[max_row][k] = temp;
-            }
-            
-
-            int temp_pivot = pivot[j];
-            pivot[j] = pivot[max_row];
-            pivot[max_row] = temp_pivot;
-            det *= -1; 
-        }
-        
-        // Check for singular matrix
-        if (fabs(LU->data[j][j]) < 1e-12) {
-            free_matrix(LU);
-            free(pivot);
-            return 0.0; // Matrix is singular
-        }
-        
-
-        det *= LU->data[j][j];
-        
-        // Update lower rows in parallel
-        #ifdef _OPENMP
-        #pragma omp parallel for if(is_openmp_enabled())
-        #endif
-        for (int i = j + 1; i < n; i++) {
-            LU->data[i][j] /= LU->data[j][j]; 
-            for (int k = j + 1; k < n; k++) {
-                LU->data[i][k] -= LU->data[i][j] * LU->data[j][k]; 
-            }
-        }
-    }
-    
-
-    free_matrix(LU);
-    free(pivot);
-    
-    return det;
+    return determinant_blocked(matrix, is_openmp_enabled());
 }
@@ -11,6 +11,11 @@
 #include "../include/process_management.h"
 #include "../include/file_operations.h"
 #include "../include/matrix_generator.h"
+#include "../include/eigen_solver.h"
+#include "../include/result_cache.h"
+#include "../include/dispatcher.h"
+#include "../include/benchmark.h"
+#include "../include/perf_counters.h"
 
 extern int use_openmp_flag;
 
@@ -177,6 +182,7 @@ int handle_menu_choice(int choice) {
             break;
         case 9: 
             display_all_matrices(); 
+            result_cache_print_stats();
             break;
         case 10: 
             handle_matrix_operations(1); // Addition
@@ -204,6 +210,8 @@ int handle_menu_choice(int choice) {
             break;
         case 18: 
             printf("Exiting program...\n");
+            result_cache_print_stats();
+            if (global_config.show_timings) perf_print_engine_stats();
             cleanup_process_pool();
             clear_matrix_registry();
             should_exit = 1;
@@ -215,6 +223,12 @@ int handle_menu_choice(int choice) {
     return should_exit;
 }
 
+// Menu method choices 1-3 name an engine directly; 4 leaves it to the
+// dispatcher, which still honours an engine forced in the config.
+static engine_t method_engine(int method) {
+    return method == 4 ? ENGINE_AUTO : (engine_t)method;
+}
+
 void handle_matrix_operations(int op_type) {
     printf("\n=== MATRIX OPERATIONS ===\n");
     display_all_matrices();
@@ -236,8 +250,8 @@ void handle_matrix_operations(int op_type) {
     
     printf("Performing matrix %s...\n", operation_name);
     
-    int matrix1_id = get_user_choice("Enter first matrix ID", 1, next_matrix_id - 1);
-    int matrix2_id = get_user_choice("Enter second matrix ID", 1, next_matrix_id - 1);
+    int matrix1_id = get_matrix_choice("Enter first matrix ID or name");
+    int matrix2_id = get_matrix_choice("Enter second matrix ID or name");
     
     matrix_t* A = find_matrix_by_id(matrix1_id);
     matrix_t* B = find_matrix_by_id(matrix2_id);
@@ -251,55 +265,32 @@ void handle_matrix_operations(int op_type) {
     printf("1. Sequential\n");
     printf("2. Parallel (Processes)\n"); 
     printf("3. OpenMP\n");
-    int method = get_user_choice("Select method", 1, 3);
+    printf("4. Auto (cost model)\n");
+    int method = get_user_choice("Select method", 1, 4);
+    
+    static const cache_op_t cache_ops[] = { CACHE_OP_ADD, CACHE_OP_SUBTRACT, CACHE_OP_MULTIPLY };
+    cache_key_t cache_key = result_cache_key(cache_ops[op_type - 1], 0, 0, A, B);
     
     performance_timer_t timer;
     start_timer(&timer);
     
-    matrix_t* result = NULL;
-    const char* method_name = "";
+    matrix_t* result = result_cache_get_matrix(&cache_key);
+    int cached = result != NULL;
+    const char* method_name = "cached result";
     
-    switch (op_type) {
-        case 1:
-            if (method == 1) {
-                result = add_matrices_seq(A, B);
-                method_name = "sequential";
-            } else if (method == 2) {
-                result = add_matrices_parallel(A, B);
-                method_name = "parallel processes";
-            } else {
-                result = add_matrices_openmp(A, B);
-                method_name = "OpenMP";
-            }
-            break;
-        case 2:
-            if (method == 1) {
-                result = subtract_matrices_seq(A, B);
-                method_name = "sequential";
-            } else if (method == 2) {
-                result = subtract_matrices_parallel(A, B);
-                method_name = "parallel processes";
-            } else {
-                result = subtract_matrices_openmp(A, B);
-                method_name = "OpenMP";
-            }
-            break;
-        case 3:
-            if (method == 1) {
-                result = multiply_matrices_seq(A, B);
-                method_name = "sequential";
-            } else if (method == 2) {
-                result = multiply_matrices_parallel(A, B);
-                method_name = "parallel processes";
-            } else {
-                result = multiply_matrices_openmp(A, B);
-                method_name = "OpenMP";
-            }
-            break;
+    if (!result) {
+        static const dispatch_op_t dispatch_ops[] = { DISPATCH_ADD, DISPATCH_SUBTRACT, DISPATCH_MULTIPLY };
+        engine_t used;
+        result = dispatch_binary(dispatch_ops[op_type - 1], method_engine(method), A, B, &used);
+        method_name = engine_name(used);
     }
     
     stop_timer(&timer);
     
+    if (result && !cached) {
+        result_cache_put_matrix(&cache_key, result);
+    }
+    
     if (result) {
         char result_name[50];
         snprintf(result_name, sizeof(result_name), "Result_%s_%d_%d", operation_name, matrix1_id, matrix2_id);
@@ -308,6 +299,7 @@ void handle_matrix_operations(int op_type) {
         if (add_matrix_to_registry(result) >= 0) {
             printf("✓ %s completed in %.6f seconds using %s\n", 
                    operation_name, get_elapsed_time(&timer), method_name);
+            if (global_config.show_timings && !cached) perf_print_sample(perf_last_sample());
             printf("Result matrix (ID: %d):\n", result->id);
             display_matrix(result);
         } else {
@@ -328,7 +320,7 @@ void handle_eigen_calculation() {
         return;
     }
     
-    int matrix_id = get_user_choice("Enter matrix ID", 1, next_matrix_id - 1);
+    int matrix_id = get_matrix_choice("Enter matrix ID or name");
     matrix_t* matrix = find_matrix_by_id(matrix_id);
     
     if (!matrix) {
@@ -342,10 +334,16 @@ void handle_eigen_calculation() {
     }
     
     printf("\nCalculation methods:\n");
-    printf("1. Quick (QR Algorithm - for small matrices)\n");
-    printf("2. Accurate (All eigenvalues for 2x2, dominant for larger)\n");
-    printf("3. Dominant Only (Power Method - for large matrices)\n");
-    int method = get_user_choice("Select method", 1, 3);
+    printf("1. Full spectrum (Hessenberg reduction + shifted QR)\n");
+    printf("2. Automatic (best solver for the matrix)\n");
+    printf("3. Dominant Only (Power Method)\n");
+    printf("4. Symmetric Jacobi (parallel rotations)\n");
+    printf("5. Top-k eigenvalues (restarted Arnoldi/Lanczos)\n");
+    int method = get_user_choice("Select method", 1, 5);
+    int top_k = 0;
+    if (method == 5) {
+        top_k = get_user_choice("How many eigenvalues", 1, matrix->rows);
+    }
     
     printf("Calculating eigenvalues and eigenvectors for matrix %d (%dx%d)...\n", 
            matrix_id, matrix->rows, matrix->rows);
@@ -355,41 +353,74 @@ void handle_eigen_calculation() {
     
     eigen_t* eigenvalues = NULL;
     int eigen_count = 0;
-    int result = -1;
-    
-    switch (method) {
+    static const cache_eigen_variant_t variants[] = {
+        CACHE_EIGEN_QR, CACHE_EIGEN_AUTO, CACHE_EIGEN_DOMINANT, CACHE_EIGEN_JACOBI, CACHE_EIGEN_TOP_K
+    };
+    cache_key_t cache_key = result_cache_key(CACHE_OP_EIGEN, variants[method - 1], top_k, matrix, NULL);
+    int result = result_cache_get_eigen(&cache_key, &eigenvalues, &eigen_count);
+    int cached = result == 0;
+    perf_sample_t counters;
+    perf_begin(&counters);
+    
+    if (!cached) switch (method) {
         case 1:
-            if (matrix->rows <= 10) {
-                result = find_eigenvalues_qr(matrix, &eigenvalues, &eigen_count);
-            } else {
-                printf("Matrix too large for QR, using Power Method instead.\n");
-                result = find_eigenvalues_eigenvectors(matrix, &eigenvalues, &eigen_count);
-            }
+            result = find_eigenvalues_qr(matrix, &eigenvalues, &eigen_count);
             break;
         case 2:
             result = find_eigenvalues_eigenvectors(matrix, &eigenvalues, &eigen_count);
             break;
         case 3:
-            if (matrix->rows > 2) {
-                result = find_eigenvalues_eigenvectors(matrix, &eigenvalues, &eigen_count);
+            eigenvalues = (eigen_t*)calloc(1, sizeof(eigen_t));
+            if (eigenvalues) {
+                eigenvalues[0].eigenvector = (double*)malloc(matrix->rows * sizeof(double));
+            }
+            if (!eigenvalues || !eigenvalues[0].eigenvector) {
+                printf("Memory allocation failed for eigen results\n");
+                free_eigen_results(eigenvalues, 1);
+                eigenvalues = NULL;
+                result = -1;
+                break;
+            }
+            result = find_dominant_eigenvalue(matrix, &eigenvalues[0].eigenvalue,
+                                              eigenvalues[0].eigenvector);
+            eigen_count = 1;
+            if (result != 0) {
+                free_eigen_results(eigenvalues, eigen_count);
+                eigenvalues = NULL;
+            }
+            break;
+        case 4:
+            if (eigen_matrix_is_symmetric(matrix)) {
+                result = eigen_solve_symmetric_jacobi(matrix, &eigenvalues, &eigen_count);
             } else {
-                printf("Power Method is for larger matrices. Using QR instead.\n");
+                printf("Matrix is not symmetric, using full spectrum QR instead.\n");
                 result = find_eigenvalues_qr(matrix, &eigenvalues, &eigen_count);
             }
             break;
+        case 5:
+            result = find_eigenvalues_auto(matrix, top_k, &eigenvalues, &eigen_count, NULL);
+            break;
     }
     
     stop_timer(&timer);
+    perf_end(&counters);
     
     if (result == 0 && eigenvalues) {
+        if (!cached) {
+            result_cache_put_eigen(&cache_key, eigenvalues, eigen_count, matrix->rows);
+        }
         display_eigen_results(eigenvalues, eigen_count, matrix->rows);
-        printf("Calculation time: %.6f seconds\n", get_elapsed_time(&timer));
+        printf("Calculation time: %.6f seconds%s\n", get_elapsed_time(&timer),
+               cached ? " (cached result)" : "");
+        if (global_config.show_timings && !cached) perf_print_sample(&counters);
         
         const char* method_name = "";
         switch (method) {
-            case 1: method_name = "Quick (QR)"; break;
-            case 2: method_name = "Accurate"; break;
+            case 1: method_name = "Full spectrum (QR)"; break;
+            case 2: method_name = "Automatic"; break;
             case 3: method_name = "Dominant (Power Method)"; break;
+            case 4: method_name = "Symmetric Jacobi"; break;
+            case 5: method_name = "Top-k (Arnoldi/Lanczos)"; break;
         }
         printf("Method: %s\n", method_name);
         
@@ -412,15 +443,15 @@ void handle_matrix_input() {
     }
     
     printf("Rows: ");
-    if (scanf("%d", &rows) != 1 || rows <= 0 || rows > MAX_MATRIX_SIZE) {
-        printf("Invalid rows! Must be between 1 and %d\n", MAX_MATRIX_SIZE);
+    if (scanf("%d", &rows) != 1 || rows <= 0 || rows > MATRIX_MAX_DIMENSION) {
+        printf("Invalid rows! Must be between 1 and %d\n", MATRIX_MAX_DIMENSION);
         clear_input_buffer();
         return;
     }
     
     printf("Columns: ");
-    if (scanf("%d", &cols) != 1 || cols <= 0 || cols > MAX_MATRIX_SIZE) {
-        printf("Invalid columns! Must be between 1 and %d\n", MAX_MATRIX_SIZE);
+    if (scanf("%d", &cols) != 1 || cols <= 0 || cols > MATRIX_MAX_DIMENSION) {
+        printf("Invalid columns! Must be between 1 and %d\n", MATRIX_MAX_DIMENSION);
         clear_input_buffer();
         return;
     }
@@ -461,7 +492,7 @@ void handle_matrix_display() {
         return;
     }
     
-    int matrix_id = get_user_choice("Enter matrix ID", 1, next_matrix_id - 1);
+    int matrix_id = get_matrix_choice("Enter matrix ID or name");
     matrix_t* matrix = find_matrix_by_id(matrix_id);
     
     if (matrix) {
@@ -505,9 +536,11 @@ void delete_matrix_from_folder_helper(matrix_t* matrix, const char* folder_path,
     int deleted = 0;
     
 
-    int path_len = snprintf(filename, MAX_FILENAME - 1, "%s/%s.txt", folder_path, matrix->name);
-    if (path_len < MAX_FILENAME) {
-        if (remove(filename) == 0) {
+    static const char* extensions[] = { "mat", "txt" };
+    int path_len;
+    for (int e = 0; e < 2; e++) {
+        path_len = snprintf(filename, MAX_FILENAME - 1, "%s/%s.%s", folder_path, matrix->name, extensions[e]);
+        if (path_len < MAX_FILENAME && remove(filename) == 0) {
             printf("✓ Matrix deleted from %s: %s\n", folder_type, filename);
             deleted = 1;
         }
@@ -549,7 +582,7 @@ void handle_matrix_deletion() {
         return;
     }
     
-    int matrix_id = get_user_choice("Enter matrix ID to delete", 1, next_matrix_id - 1);
+    int matrix_id = get_matrix_choice("Enter matrix ID or name to delete");
     
     printf("\nDelete options:\n");
     printf("1. Delete from memory only\n");
@@ -609,7 +642,7 @@ void handle_matrix_modification() {
         return;
     }
     
-    int matrix_id = get_user_choice("Enter matrix ID to modify", 1, next_matrix_id - 1);
+    int matrix_id = get_matrix_choice("Enter matrix ID or name to modify");
     matrix_t* matrix = find_matrix_by_id(matrix_id);
     
     if (!matrix) {
@@ -625,6 +658,8 @@ void handle_matrix_modification() {
     printf("3. Modify entire column\n");
     
     int choice = get_user_choice("Select modification type", 1, 3);
+    // Even a partial edit changes the contents, so mark it up front.
+    matrix_mark_modified(matrix);
     
     switch (choice) {
         case 1: {
@@ -680,7 +715,7 @@ void handle_determinant_calculation() {
         return;
     }
     
-    int matrix_id = get_user_choice("Enter matrix ID", 1, next_matrix_id - 1);
+    int matrix_id = get_matrix_choice("Enter matrix ID or name");
     matrix_t* matrix = find_matrix_by_id(matrix_id);
     
     if (!matrix) {
@@ -697,31 +732,34 @@ void handle_determinant_calculation() {
     printf("1. Sequential\n");
     printf("2. Parallel (Processes)\n");
     printf("3. OpenMP\n");
-    int method = get_user_choice("Select method", 1, 3);
+    printf("4. Auto (cost model)\n");
+    int method = get_user_choice("Select method", 1, 4);
     
     performance_timer_t timer;
     start_timer(&timer);
     
+    cache_key_t cache_key = result_cache_key(CACHE_OP_DETERMINANT, 0, 0, matrix, NULL);
     double det;
-    const char* method_name = "";
-    
-    if (method == 1) {
-        det = matrix_determinant_seq(matrix);
-        method_name = "sequential";
-    } else if (method == 2) {
-        det = matrix_determinant_parallel(matrix);
-        method_name = "parallel processes";
-    } else {
-        det = matrix_determinant_openmp(matrix);
-        method_name = "OpenMP";
+    const char* method_name = "cached result";
+    int cached = result_cache_get_determinant(&cache_key, &det) == 0;
+    
+    if (!cached) {
+        engine_t used;
+        det = dispatch_determinant(method_engine(method), matrix, &used);
+        method_name = engine_name(used);
     }
     
     stop_timer(&timer);
     
+    if (!cached) {
+        result_cache_put_determinant(&cache_key, det);
+    }
+    
     printf("\n=== RESULT ===\n");
     printf("Matrix: %s (ID: %d, %dx%d)\n", matrix->name, matrix->id, matrix->rows, matrix->cols);
     printf("Determinant: %.6f\n", det);
     printf("Calculation time (%s): %.6f seconds\n", method_name, get_elapsed_time(&timer));
+    if (global_config.show_timings && !cached) perf_print_sample(perf_last_sample());
     printf("================\n");
 }
 void handle_performance_comparison() {
@@ -735,7 +773,7 @@ void handle_performance_comparison() {
     if (scanf("%d", &change_size) == 1 && change_size == 1) {
         printf("Enter new test size: ");
         if (scanf("%d", &test_size) == 1) {
-            if (test_size <= 0 || test_size > MAX_MATRIX_SIZE) {
+            if (test_size <= 0 || test_size > MATRIX_MAX_DIMENSION) {
                 printf("Invalid size! Using configured size: %d\n", global_config.performance_test_size);
                 test_size = global_config.performance_test_size;
             }
@@ -756,88 +794,31 @@ void handle_performance_comparison() {
         return;
     }
     
-    printf("Testing matrix multiplication...\n");
-    
-    performance_timer_t sequential_timer, parallel_timer, openmp_timer;
-    matrix_t* result_seq = NULL;
-    matrix_t* result_par = NULL;
-    matrix_t* result_omp = NULL;
-    
-    int success_seq = 0, success_par = 0, success_omp = 0;
-    
-
-    printf("1. Sequential execution...\n");
-    start_timer(&sequential_timer);
-    result_seq = multiply_matrices_seq(A, B);
-    stop_timer(&sequential_timer);
-    if (result_seq != NULL) {
-        success_seq = 1;
-        printf("   ✓ Completed successfully\n");
-    } else {
-        printf("   ✗ Failed!\n");
-    }
-    
-
-    printf("2. Parallel execution (processes)...\n");
-    start_timer(&parallel_timer);
-    result_par = multiply_matrices_parallel(A, B);
-    stop_timer(&parallel_timer);
-    if (result_par != NULL) {
-        success_par = 1;
-        printf("   ✓ Completed successfully\n");
-    } else {
-        printf("   ✗ Failed!\n");
-    }
-    
-    // 3. OpenMP
-    printf("3. OpenMP execution...\n");
-    start_timer(&openmp_timer);
-    result_omp = multiply_matrices_openmp(A, B);
-    stop_timer(&openmp_timer);
-    if (result_omp != NULL) {
-        success_omp = 1;
-        printf("   ✓ Completed successfully\n");
-    } else {
-        printf("   ✗ Failed!\n");
-    }
-    
-
-    printf("\n=== PERFORMANCE RESULTS ===\n");
-    if (success_seq) {
-        printf("Sequential:  %.6f seconds\n", get_elapsed_time(&sequential_timer));
-    } else {
-        printf("Sequential:  FAILED\n");
-    }
-    
-    if (success_par) {
-        printf("Parallel:    %.6f seconds", get_elapsed_time(&parallel_timer));
-        if (success_seq) {
-            double speedup = get_elapsed_time(&sequential_timer) / get_elapsed_time(&parallel_timer);
-            printf(" (Speedup: %.2fx)", speedup);
-        }
-        printf("\n");
-    } else {
-        printf("Parallel:    FAILED\n");
-    }
-    
-    if (success_omp) {
-        printf("OpenMP:      %.6f seconds", get_elapsed_time(&openmp_timer));
-        if (success_seq) {
-            double speedup = get_elapsed_time(&sequential_timer) / get_elapsed_time(&openmp_timer);
-            printf(" (Speedup: %.2fx)", speedup);
+    int warmup = global_config.benchmark_warmup;
+    int runs = global_config.benchmark_runs;
+    printf("Each engine: %d warm-up run(s), %d timed run(s)\n", warmup, runs);
+    
+    static const struct {
+        dispatch_op_t op;
+        const char* title;
+    } benchmarks[] = {
+        { DISPATCH_MULTIPLY, "MATRIX MULTIPLICATION" },
+        { DISPATCH_ADD, "MATRIX ADDITION" },
+        { DISPATCH_DETERMINANT, "DETERMINANT" },
+    };
+    for (int i = 0; i < 3; i++) {
+        printf("Benchmarking %s...\n", benchmarks[i].title);
+        bench_result_t results[BENCH_ENGINES];
+        const matrix_t* second = benchmarks[i].op == DISPATCH_DETERMINANT ? NULL : B;
+        if (benchmark_operation(benchmarks[i].op, A, second, warmup, runs, results) != 0) {
+            printf("✗ Sequential reference failed, results are unchecked\n");
         }
-        printf("\n");
-    } else {
-        printf("OpenMP:      FAILED\n");
+        benchmark_print(benchmarks[i].title, results, BENCH_ENGINES);
     }
     printf("==========================\n");
     
-
     free_matrix(A);
     free_matrix(B);
-    if (result_seq) free_matrix(result_seq);
-    if (result_par) free_matrix(result_par);
-    if (result_omp) free_matrix(result_omp);
 }
 
 void handle_openmp_toggle() {
@@ -880,6 +861,26 @@ int get_user_choice(const char* prompt, int min, int max) {
     }
 }
 
+// Reads a matrix ID or name and returns the ID of a registered matrix.
+// Tokens made only of digits are IDs; anything else is looked up by name.
+// Returns -1 at end of input.
+int get_matrix_choice(const char* prompt) {
+    char token[50];
+    while (1) {
+        printf("%s: ", prompt);
+        if (scanf("%49s", token) != 1) return -1;
+        clear_input_buffer();
+
+        char* end;
+        long id = strtol(token, &end, 10);
+        matrix_t* matrix = (*end == '\0' && id > 0 && id < next_matrix_id)
+                               ? find_matrix_by_id((int)id) : NULL;
+        if (!matrix) matrix = find_matrix_by_name(token);
+        if (matrix) return matrix->id;
+        printf("No matrix with ID or name '%s'!\n", token);
+    }
+}
+
 void clear_input_buffer() {
     int c;
     while ((c = getchar()) != '\n' && c != EOF);
@@ -0,0 +1,329 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/perf_counters.h"
+#include "../include/config.h"
+#include "../include/process_management.h"
+
+// One perf event group per counted task, so a single read() returns all
+// of its counters. members lists the events in group order.
+typedef struct {
+    pid_t tid;
+    int worker;   // a pool worker, retired once it leaves the pool
+    int fds[PERF_EVENT_COUNT];
+    perf_event_id_t events[PERF_EVENT_COUNT];
+    int members;
+} perf_task_t;
+
+typedef struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[PERF_EVENT_COUNT];
+} perf_group_read_t;
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char* name;
+} event_specs[PERF_EVENT_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND, "stalled_frontend" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND, "stalled_backend" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page_faults" }
+};
+
+static perf_task_t tasks[PERF_MAX_TASKS];
+static int task_count = 0;
+static double retired[PERF_EVENT_COUNT];   // final counts of departed workers
+static unsigned available_events = 0;
+static int openmp_attached = 1;   // the main thread is OpenMP thread 0
+static int depth = 0;
+static perf_sample_t last_sample;
+static perf_engine_stats_t engine_stats[ENGINE_OPENMP + 1];
+
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int group_fd) {
+    return (int)syscall(SYS_perf_event_open, attr, pid, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+// Opens the wanted events on tid as one group; the kernel rejects members
+// the PMU cannot schedule together with the rest, which are then skipped.
+// User-space counting only, which perf_event_paranoid=2 still allows.
+static int attach_task(pid_t tid, unsigned wanted, int worker) {
+    if (task_count == PERF_MAX_TASKS) return -1;
+    for (int t = 0; t < task_count; t++) {
+        if (tasks[t].tid == tid) return 0;
+    }
+
+    perf_task_t* task = &tasks[task_count];
+    task->tid = tid;
+    task->worker = worker;
+    task->members = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (!(wanted & (1u << e))) continue;
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event_specs[e].type;
+        attr.config = event_specs[e].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = perf_event_open(&attr, tid, task->members > 0 ? task->fds[0] : -1);
+        if (fd < 0) continue;
+        task->fds[task->members] = fd;
+        task->events[task->members] = (perf_event_id_t)e;
+        task->members++;
+    }
+    if (task->members == 0) return -1;
+    task_count++;
+    return 0;
+}
+
+// OpenMP threads are created by the first parallel region of a given size,
+// so they are attached lazily: each thread of a team as large as the
+// current maximum registers itself once.
+static void attach_openmp_threads(void) {
+#ifdef _OPENMP
+    int wanted = omp_get_max_threads();
+    if (wanted <= openmp_attached) return;
+    #pragma omp parallel num_threads(wanted)
+    {
+        if (omp_get_thread_num() != 0) {
+            pid_t tid = (pid_t)syscall(SYS_gettid);
+            #pragma omp critical(perf_attach)
+            attach_task(tid, available_events, 0);
+        }
+    }
+    openmp_attached = wanted;
+#endif
+}
+
+unsigned perf_counters_init(void) {
+    perf_counters_shutdown();
+    if (!global_config.perf_counters) return 0;
+
+    if (attach_task((pid_t)syscall(SYS_gettid), (1u << PERF_EVENT_COUNT) - 1, 0) != 0) return 0;
+    for (int i = 0; i < tasks[0].members; i++) {
+        available_events |= 1u << tasks[0].events[i];
+    }
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (process_pool[i].pid > 0) attach_task(process_pool[i].pid, available_events, 1);
+    }
+    return available_events;
+}
+
+void perf_counters_shutdown(void) {
+    for (int t = 0; t < task_count; t++) {
+        for (int i = 0; i < tasks[t].members; i++) {
+            close(tasks[t].fds[i]);
+        }
+    }
+    task_count = 0;
+    memset(retired, 0, sizeof(retired));
+    available_events = 0;
+    openmp_attached = 1;
+    depth = 0;
+    memset(&last_sample, 0, sizeof(last_sample));
+    memset(engine_stats, 0, sizeof(engine_stats));
+}
+
+unsigned perf_counters_available(void) {
+    return available_events;
+}
+
+void perf_print_available(void) {
+    if (!global_config.perf_counters) {
+        printf("Hardware counters: disabled\n");
+        return;
+    }
+    if (!available_events) {
+        printf("Hardware counters: unavailable (perf_event_open refused)\n");
+        return;
+    }
+    printf("Hardware counters:");
+    const char* separator = " ";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (!(available_events & (1u << e))) continue;
+        printf("%s%s", separator, event_specs[e].name);
+        separator = ", ";
+    }
+    printf(" on %d task(s)\n", task_count);
+}
+
+// Adds the task's running totals to values, scaled up for the time an
+// event was multiplexed out. Tasks that have exited keep their final counts.
+static void add_task_counts(const perf_task_t* task, double* values) {
+    perf_group_read_t group;
+    ssize_t got = read(task->fds[0], &group, sizeof(group));
+    if (got < (ssize_t)(3 * sizeof(uint64_t)) || group.time_running == 0) return;
+    double scale = (double)group.time_enabled / (double)group.time_running;
+    for (uint64_t i = 0; i < group.nr && i < (uint64_t)task->members; i++) {
+        values[task->events[i]] += (double)group.values[i] * scale;
+    }
+}
+
+static void read_totals(double* values) {
+    memcpy(values, retired, sizeof(retired));
+    for (int t = 0; t < task_count; t++) {
+        add_task_counts(&tasks[t], values);
+    }
+}
+
+static int in_pool(pid_t pid) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (process_pool[i].pid == pid) return 1;
+    }
+    return 0;
+}
+
+void perf_attach_worker(pid_t pid) {
+    if (task_count == 0) return;
+    // Fold workers that have left the pool into the retired totals so the
+    // sums stay monotonic and their slots in tasks are reused.
+    for (int t = task_count - 1; t > 0; t--) {
+        if (!tasks[t].worker || in_pool(tasks[t].tid)) continue;
+        add_task_counts(&tasks[t], retired);
+        for (int i = 0; i < tasks[t].members; i++) {
+            close(tasks[t].fds[i]);
+        }
+        tasks[t] = tasks[--task_count];
+    }
+    attach_task(pid, available_events, 1);
+}
+
+void perf_begin(perf_sample_t* sample) {
+    memset(sample, 0, sizeof(*sample));
+    if (depth++ > 0 || task_count == 0) return;
+    attach_openmp_threads();
+    sample->active = 1;
+    sample->valid = available_events;
+    read_totals(sample->values);
+}
+
+void perf_end(perf_sample_t* sample) {
+    depth--;
+    if (!sample->active) return;
+    double now[PERF_EVENT_COUNT];
+    read_totals(now);
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        sample->values[e] = now[e] > sample->values[e] ? now[e] - sample->values[e] : 0.0;
+    }
+    last_sample = *sample;
+}
+
+void perf_record_engine(engine_t engine, const perf_sample_t* sample) {
+    if (!sample->active || engine < ENGINE_SEQUENTIAL || engine > ENGINE_OPENMP) return;
+    perf_engine_stats_t* stats = &engine_stats[engine];
+    stats->calls++;
+    stats->total.active = 1;
+    stats->total.valid = sample->valid;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        stats->total.values[e] += sample->values[e];
+    }
+}
+
+const perf_sample_t* perf_last_sample(void) {
+    return &last_sample;
+}
+
+const perf_engine_stats_t* perf_engine_stats(engine_t engine) {
+    return &engine_stats[engine];
+}
+
+void perf_sample_scale(perf_sample_t* sample, double n) {
+    if (n <= 0.0) return;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        sample->values[e] /= n;
+    }
+}
+
+const char* perf_event_name(perf_event_id_t event) {
+    return event_specs[event].name;
+}
+
+double perf_sample_ipc(const perf_sample_t* sample) {
+    unsigned both = (1u << PERF_CYCLES) | (1u << PERF_INSTRUCTIONS);
+    if ((sample->valid & both) != both || sample->values[PERF_CYCLES] <= 0.0) return 0.0;
+    return sample->values[PERF_INSTRUCTIONS] / sample->values[PERF_CYCLES];
+}
+
+// Three significant digits with a K/M/G suffix, "-" when not counted.
+static const char* format_count(char* buffer, size_t size, const perf_sample_t* sample,
+                                perf_event_id_t event) {
+    if (!(sample->valid & (1u << event))) return "-";
+    double value = sample->values[event];
+    if (value >= 1e9) snprintf(buffer, size, "%.3gG", value * 1e-9);
+    else if (value >= 1e6) snprintf(buffer, size, "%.3gM", value * 1e-6);
+    else if (value >= 1e3) snprintf(buffer, size, "%.3gK", value * 1e-3);
+    else snprintf(buffer, size, "%.0f", value);
+    return buffer;
+}
+
+void perf_print_sample(const perf_sample_t* sample) {
+    if (!sample->active) return;
+    char buffer[32];
+    printf("Counters:");
+    const char* separator = " ";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (!(sample->valid & (1u << e))) continue;
+        printf("%s%s %s", separator, format_count(buffer, sizeof(buffer), sample, (perf_event_id_t)e),
+               perf_event_name((perf_event_id_t)e));
+        separator = ", ";
+    }
+    double ipc = perf_sample_ipc(sample);
+    if (ipc > 0.0) printf(" (IPC %.2f)", ipc);
+    printf("\n");
+}
+
+void perf_print_header(const char* label) {
+    printf("%-24s %9s %9s %5s %9s %9s %9s %9s %9s\n", label, "Cycles", "Instr", "IPC",
+           "LLC miss", "Br miss", "FE stall", "BE stall", "Faults");
+}
+
+void perf_print_row(const char* label, const perf_sample_t* sample) {
+    char b[PERF_EVENT_COUNT][32];
+    char ipc[16] = "-";
+    if (perf_sample_ipc(sample) > 0.0) snprintf(ipc, sizeof(ipc), "%.2f", perf_sample_ipc(sample));
+    printf("%-24s %9s %9s %5s %9s %9s %9s %9s %9s\n", label,
+           format_count(b[0], sizeof(b[0]), sample, PERF_CYCLES),
+           format_count(b[1], sizeof(b[1]), sample, PERF_INSTRUCTIONS), ipc,
+           format_count(b[2], sizeof(b[2]), sample, PERF_CACHE_MISSES),
+           format_count(b[3], sizeof(b[3]), sample, PERF_BRANCH_MISSES),
+           format_count(b[4], sizeof(b[4]), sample, PERF_STALLED_FRONTEND),
+           format_count(b[5], sizeof(b[5]), sample, PERF_STALLED_BACKEND),
+           format_count(b[6], sizeof(b[6]), sample, PERF_PAGE_FAULTS));
+}
+
+void perf_print_engine_stats(void) {
+    if (task_count == 0) return;
+    int any = 0;
+    for (int engine = ENGINE_SEQUENTIAL; engine <= ENGINE_OPENMP; engine++) {
+        if (engine_stats[engine].calls > 0) any = 1;
+    }
+    if (!any) return;
+
+    printf("\n=== HARDWARE COUNTERS PER ENGINE CALL (averages) ===\n");
+    perf_print_header("Engine (calls)");
+    for (int engine = ENGINE_SEQUENTIAL; engine <= ENGINE_OPENMP; engine++) {
+        const perf_engine_stats_t* stats = &engine_stats[engine];
+        if (stats->calls == 0) continue;
+        perf_sample_t average = stats->total;
+        perf_sample_scale(&average, (double)stats->calls);
+        char label[40];
+        snprintf(label, sizeof(label), "%s (%lu)", engine_name((engine_t)engine), stats->calls);
+        perf_print_row(label, &average);
+    }
+}
@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -6,10 +7,19 @@
 #include <string.h>
 #include <signal.h>
 #include <errno.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "../include/process_management.h"
+#include "../include/gemm.h"
+#include "../include/simd_kernels.h"
+#include "../include/lu_decomposition.h"
+#include "../include/trace.h"
+#include "../include/perf_counters.h"
 
 child_process_t process_pool[MAX_PROCESSES];
 int active_processes = 0;
+int pool_verbose = 1;
 
 volatile sig_atomic_t computation_started = 0;
 volatile sig_atomic_t computation_completed = 0;
@@ -34,7 +44,7 @@ void child_cleanup_handler(int sig) {
     pid_t pid;
     
     while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        for (int i = 0; i < global_config.max_processes; i++) {
+        for (int i = 0; i < MAX_PROCESSES; i++) {
             if (process_pool[i].pid == pid) {
                 process_pool[i].pid = -1;
                 active_processes--;
@@ -63,16 +73,103 @@ void setup_signal_handlers() {
 }
 
 void send_signal_to_children(int sig) {
-    for (int i = 0; i < global_config.max_processes; i++) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
         if (process_pool[i].pid > 0) {
             kill(process_pool[i].pid, sig);
         }
     }
 }
 
+static int pool_size = 0;
+
+// Shared-memory segment holding the operands and result of one operation.
+typedef struct {
+    unsigned id;
+    double* base;
+    size_t size;
+} shm_arena_t;
+
+static unsigned next_arena_id = 1;
+
+// Pending tiles of one operation; idle workers are fed from the front.
+// lost counts accumulating tiles whose worker died mid-way; those cannot
+// be recomputed because part of the update may already be in place.
+typedef struct {
+    double* base;
+    tile_job_t* tiles;
+    int next;
+    int total;
+    int lost;
+} job_queue_t;
+
+typedef struct {
+    child_process_t* worker;
+    int tile;
+} job_slot_t;
+
+static int effective_pool_size() {
+    int size = global_config.process_pool_size;
+    if (size > global_config.max_processes) size = global_config.max_processes;
+    if (size > MAX_PROCESSES) size = MAX_PROCESSES;
+    if (size < 1) size = 1;
+    return size;
+}
+
+static int write_all(int fd, const void* buffer, size_t size) {
+    const char* data = (const char*)buffer;
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void* buffer, size_t size) {
+    char* data = (char*)buffer;
+    while (size > 0) {
+        ssize_t got = read(fd, data, size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (got == 0) return -1;
+        data += got;
+        size -= (size_t)got;
+    }
+    return 0;
+}
+
+static void close_process_pipes(child_process_t* process) {
+    if (process->pipe_in[0] != -1) close(process->pipe_in[0]);
+    if (process->pipe_in[1] != -1) close(process->pipe_in[1]);
+    if (process->pipe_out[0] != -1) close(process->pipe_out[0]);
+    if (process->pipe_out[1] != -1) close(process->pipe_out[1]);
+    process->pipe_in[0] = process->pipe_in[1] = -1;
+    process->pipe_out[0] = process->pipe_out[1] = -1;
+}
+
+static void stop_worker(child_process_t* process) {
+    if (process->pid > 0) {
+        // Clear the slot first so child_cleanup_handler does not count it twice.
+        pid_t pid = process->pid;
+        process->pid = -1;
+        active_processes--;
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+    close_process_pipes(process);
+    process->busy = 0;
+}
+
 void initialize_process_pool() {
-    printf("Initializing process pool with %d processes\n", global_config.max_processes);
-    for (int i = 0; i < global_config.max_processes; i++) {
+    pool_size = effective_pool_size();
+    printf("Initializing process pool with %d processes\n", pool_size);
+    for (int i = 0; i < MAX_PROCESSES; i++) {
         process_pool[i].pid = -1;
         process_pool[i].busy = 0;
         process_pool[i].last_used = 0;
@@ -80,143 +177,476 @@ void initialize_process_pool() {
         process_pool[i].pipe_out[0] = process_pool[i].pipe_out[1] = -1;
     }
     active_processes = 0;
+    
+    if (!global_config.enable_process_pool) return;
+    
+    for (int i = 0; i < pool_size; i++) {
+        if (create_worker_process(&process_pool[i]) != 0) {
+            printf("Warning: could only start %d of %d pool workers\n", i, pool_size);
+            break;
+        }
+        process_pool[i].last_used = time(NULL);
+    }
 }
 
 void cleanup_process_pool() {
     printf("Cleaning up process pool...\n");
-    for (int i = 0; i < global_config.max_processes; i++) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
         if (process_pool[i].pid > 0) {
-            kill(process_pool[i].pid, SIGTERM);
-            waitpid(process_pool[i].pid, NULL, 0);
-            
-            if (process_pool[i].pipe_in[0] != -1) close(process_pool[i].pipe_in[0]);
-            if (process_pool[i].pipe_in[1] != -1) close(process_pool[i].pipe_in[1]);
-            if (process_pool[i].pipe_out[0] != -1) close(process_pool[i].pipe_out[0]);
-            if (process_pool[i].pipe_out[1] != -1) close(process_pool[i].pipe_out[1]);
-            
-            process_pool[i].pid = -1;
+            stop_worker(&process_pool[i]);
         }
+        close_process_pipes(&process_pool[i]);
     }
     active_processes = 0;
 }
 
-void worker_simple_calculation(int pipe_in, int pipe_out) {
+static void arena_name(char* name, size_t size, pid_t owner, unsigned id) {
+    snprintf(name, size, "/matrix_ops_%ld_%u", (long)owner, id);
+}
+
+static size_t page_round(size_t bytes) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + page - 1) / page * page;
+}
+
+static int arena_create(shm_arena_t* arena, size_t bytes) {
+    char name[64];
+    arena->id = next_arena_id++;
+    arena->size = page_round(bytes);
+    arena_name(name, sizeof(name), getpid(), arena->id);
+    
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return -1;
+    // Allocate the pages now: with ftruncate alone a full /dev/shm would
+    // only show up as SIGBUS when the operands are copied in.
+    if (posix_fallocate(fd, 0, (off_t)arena->size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    
+    void* base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+    arena->base = (double*)base;
+    return 0;
+}
+
+// Drops the arena name; mappings stay valid until each side unmaps them.
+static void arena_unlink(const shm_arena_t* arena) {
+    char name[64];
+    arena_name(name, sizeof(name), getpid(), arena->id);
+    shm_unlink(name);
+}
+
+static void compute_tile(const tile_job_t* job, double* base) {
+    const double* a = base + job->a_offset;
+    const double* b = base + job->b_offset;
+    double* c = base + job->c_offset;
+    
+    switch (job->op) {
+        case OP_ADD_TILE:
+        case OP_SUBTRACT_TILE:
+            for (int i = 0; i < job->m; i++) {
+                const double* a_row = a + (size_t)i * job->lda;
+                const double* b_row = b + (size_t)i * job->ldb;
+                double* c_row = c + (size_t)i * job->ldc;
+                if (job->op == OP_ADD_TILE) {
+                    simd_kernels.vector_add(a_row, b_row, c_row, job->n);
+                } else {
+                    simd_kernels.vector_sub(a_row, b_row, c_row, job->n);
+                }
+            }
+            break;
+        case OP_MULTIPLY_TILE:
+            // Overwrite rather than accumulate so a tile can be recomputed
+            // after a worker dies half way through it.
+            for (int i = 0; i < job->m; i++) {
+                memset(c + (size_t)i * job->ldc, 0, job->n * sizeof(double));
+            }
+            gemm_compute(job->m, job->n, job->k, job->alpha, a, job->lda, b, job->ldb, c, job->ldc, 0);
+            break;
+        case OP_LU_UPDATE_TILE:
+            gemm_compute(job->m, job->n, job->k, job->alpha, a, job->lda, b, job->ldb, c, job->ldc, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+void worker_tile_calculation(int pipe_in, int pipe_out) {
+    shm_arena_t mapped = { 0, NULL, 0 };
+    
     while (1) {
-        operation_type_t op_type;
-        double value1, value2;
-        double result;
+        tile_job_t job;
+        long long span = trace_begin();
+        int got = read_all(pipe_in, &job, sizeof(job));
+        trace_end("worker_idle", span);
+        if (got != 0) break;
         
-
-        if (read(pipe_in, &op_type, sizeof(op_type)) != sizeof(op_type)) break;
-        if (read(pipe_in, &value1, sizeof(value1)) != sizeof(value1)) break;
-        if (read(pipe_in, &value2, sizeof(value2)) != sizeof(value2)) break;
+        if (mapped.base && (mapped.id != job.arena_id || job.op == OP_RELEASE_ARENA)) {
+            munmap(mapped.base, mapped.size);
+            mapped.base = NULL;
+        }
+        if (job.op == OP_RELEASE_ARENA) continue;
         
-
-        switch (op_type) {
-            case OP_ADD_ELEMENT:
-                result = value1 + value2;
-                break;
-            case OP_SUBTRACT_ELEMENT:
-                result = value1 - value2;
-                break;
-            case OP_MULTIPLY_ELEMENT:
-                result = value1 * value2;
-                break;
-            default:
-                result = 0.0;
+        if (!mapped.base) {
+            span = trace_begin();
+            char name[64];
+            arena_name(name, sizeof(name), getppid(), job.arena_id);
+            int fd = shm_open(name, O_RDWR, 0600);
+            if (fd >= 0) {
+                void* base = mmap(NULL, job.arena_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (base != MAP_FAILED) {
+                    mapped.id = job.arena_id;
+                    mapped.base = (double*)base;
+                    mapped.size = job.arena_size;
+                }
+            }
+            trace_end("arena_map", span);
         }
         
-
-        if (write(pipe_out, &result, sizeof(result)) != sizeof(result)) break;
+        int status = -1;
+        if (mapped.base) {
+            span = trace_begin();
+            compute_tile(&job, mapped.base);
+            trace_end("tile_compute", span);
+            status = 0;
+        }
+        span = trace_begin();
+        int sent = write_all(pipe_out, &status, sizeof(status));
+        trace_end("pipe_write", span);
+        if (sent != 0) break;
     }
-    exit(0);
+    
+    if (mapped.base) munmap(mapped.base, mapped.size);
+    _exit(0);
 }
 
 int create_single_process(child_process_t* process) {
-    if (pipe(process->pipe_in) == -1 || pipe(process->pipe_out) == -1) {
+    if (pipe(process->pipe_in) == -1) {
+        return -1;
+    }
+    if (pipe(process->pipe_out) == -1) {
+        close(process->pipe_in[0]);
+        close(process->pipe_in[1]);
+        process->pipe_in[0] = process->pipe_in[1] = -1;
         return -1;
     }
     
+    fflush(stdout);
+    long long span = trace_begin();
     pid_t pid = fork();
     if (pid == -1) {
-        close(process->pipe_in[0]);
-        close(process->pipe_in[1]);
-        close(process->pipe_out[0]);
-        close(process->pipe_out[1]);
+        close_process_pipes(process);
         return -1;
     }
     
     if (pid == 0) {
+        trace_fork_child("pool worker");
+        // Drop the parent's ends of the other workers' pipes so they see EOF
+        // when the parent goes away.
+        for (int i = 0; i < MAX_PROCESSES; i++) {
+            child_process_t* other = &process_pool[i];
+            if (other == process || other->pid <= 0) continue;
+            if (other->pipe_in[1] != -1) close(other->pipe_in[1]);
+            if (other->pipe_out[0] != -1) close(other->pipe_out[0]);
+        }
 
         close(process->pipe_in[1]);
         close(process->pipe_out[0]);
         
-        worker_simple_calculation(process->pipe_in[0], process->pipe_out[1]);
+        worker_tile_calculation(process->pipe_in[0], process->pipe_out[1]);
         
         close(process->pipe_in[0]);
         close(process->pipe_out[1]);
-        exit(0);
+        _exit(0);
     } else {
-
+        trace_end("fork_worker", span);
         process->pid = pid;
+        process->busy = 0;
         close(process->pipe_in[0]);
         close(process->pipe_out[1]);
+        process->pipe_in[0] = -1;
+        process->pipe_out[1] = -1;
+        active_processes++;
+        perf_attach_worker(pid);
         return 0;
     }
 }
 
-matrix_t* add_matrices_parallel(const matrix_t* A, const matrix_t* B) {
-    if (!A || !B) return NULL;
-    
-    if (A->rows != B->rows || A->cols != B->cols) {
-        printf("Matrix dimensions don't match for parallel addition\n");
-        return NULL;
+child_process_t* get_available_process() {
+    if (pool_size == 0) pool_size = effective_pool_size();
+
+    for (int i = 0; i < pool_size; i++) {
+        if (process_pool[i].pid > 0 && !process_pool[i].busy) {
+            process_pool[i].busy = 1;
+            return &process_pool[i];
+        }
     }
     
-    matrix_t* result = create_matrix(A->rows, A->cols, "Addition_Result_Parallel");
-    if (!result) return NULL;
-    
-
-    child_process_t temp_process;
-    if (create_single_process(&temp_process) != 0) {
-        printf("Failed to create temporary process, using sequential\n");
-        free_matrix(result);
-        return add_matrices_seq(A, B);
+    // Respawn workers that exited or were reaped as idle. A worker that died
+    // with a tile still in flight stays busy until run_job_queue has seen
+    // EOF on its old pipe and recomputed the tile.
+    for (int i = 0; i < pool_size; i++) {
+        if (process_pool[i].pid <= 0 && !process_pool[i].busy) {
+            close_process_pipes(&process_pool[i]);
+            if (create_worker_process(&process_pool[i]) != 0) {
+                return NULL;
+            }
+            process_pool[i].busy = 1;
+            return &process_pool[i];
+        }
     }
     
-    int success_count = 0;
+    return NULL;
+}
+
+void return_process(child_process_t* process) {
+    if (!process) return;
+    process->busy = 0;
+    process->last_used = time(NULL);
+}
+
+// Feeds tiles from the queue to idle pool workers until every tile has been
+// computed. Workers that took part are flagged in used. Returns their count,
+// or -1 when no worker could be obtained at all.
+static int run_job_queue(job_queue_t* queue, int used[MAX_PROCESSES]) {
+    job_slot_t in_flight[MAX_PROCESSES];
+    struct pollfd fds[MAX_PROCESSES];
+    int flying = 0;
+    int completed = 0;
     
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            operation_type_t op_type = OP_ADD_ELEMENT;
-            double value1 = A->data[i][j];
-            double value2 = B->data[i][j];
-            double element_result;
+    while (completed < queue->total) {
+        while (queue->next < queue->total) {
+            child_process_t* worker = get_available_process();
+            if (!worker) break;
             
-
-            if (write(temp_process.pipe_in[1], &op_type, sizeof(op_type)) != sizeof(op_type) ||
-                write(temp_process.pipe_in[1], &value1, sizeof(value1)) != sizeof(value1) ||
-                write(temp_process.pipe_in[1], &value2, sizeof(value2)) != sizeof(value2)) {
-                continue;
+            tile_job_t* job = &queue->tiles[queue->next];
+            worker->current_op = job->op;
+            long long span = trace_begin();
+            int sent = write_all(worker->pipe_in[1], job, sizeof(*job));
+            trace_end("tile_dispatch", span);
+            if (sent != 0) {
+                stop_worker(worker);
+                compute_tile(job, queue->base);
+                completed++;
+            } else {
+                in_flight[flying].worker = worker;
+                in_flight[flying].tile = queue->next;
+                used[worker - process_pool] = 1;
+                flying++;
+            }
+            queue->next++;
+        }
+        
+        if (flying == 0) {
+            if (queue->next < queue->total) {
+                if (completed == 0) return -1;
+                while (queue->next < queue->total) {
+                    compute_tile(&queue->tiles[queue->next++], queue->base);
+                    completed++;
+                }
             }
+            continue;
+        }
+        
+        nfds_t watched = 0;
+        for (int s = 0; s < flying && s < MAX_PROCESSES; s++) {
+            fds[watched].fd = in_flight[s].worker->pipe_out[0];
+            fds[watched].events = POLLIN;
+            fds[watched].revents = 0;
+            watched++;
+        }
+        long long span = trace_begin();
+        int ready = poll(fds, watched, -1);
+        trace_end("pool_wait", span);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        for (int s = flying - 1; s >= 0; s--) {
+            if (!fds[s].revents) continue;
             
+            job_slot_t slot = in_flight[s];
+            int status = -1;
+            span = trace_begin();
+            int died = read_all(slot.worker->pipe_out[0], &status, sizeof(status)) != 0;
+            trace_end("pipe_read", span);
+            if (died) {
+                stop_worker(slot.worker);
+            } else {
+                return_process(slot.worker);
+            }
+            if (status != 0) {
+                if (died && queue->tiles[slot.tile].op == OP_LU_UPDATE_TILE) {
+                    queue->lost++;
+                } else {
+                    compute_tile(&queue->tiles[slot.tile], queue->base);
+                }
+            }
+            completed++;
+            in_flight[s] = in_flight[--flying];
+        }
+    }
+    
+    int workers = 0;
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        workers += used[i];
+    }
+    return workers;
+}
+
+static void release_arena(const shm_arena_t* arena, const int used[MAX_PROCESSES]) {
+    tile_job_t release;
+    memset(&release, 0, sizeof(release));
+    release.op = OP_RELEASE_ARENA;
+    release.arena_id = arena->id;
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (used[i] && process_pool[i].pid > 0) {
+            write_all(process_pool[i].pipe_in[1], &release, sizeof(release));
+        }
+    }
+    arena_unlink(arena);
+}
+
+// Picks a square-ish grid of about target tiles over a rows x cols output.
+static void split_tile_grid(int target, int rows, int cols, int* grid_rows, int* grid_cols) {
+    *grid_rows = 1;
+    *grid_cols = 1;
+    while (*grid_rows * *grid_cols < target) {
+        if (*grid_rows <= *grid_cols && *grid_rows < rows) (*grid_rows)++;
+        else if (*grid_cols < cols) (*grid_cols)++;
+        else if (*grid_rows < rows) (*grid_rows)++;
+        else break;
+    }
+}
+
+static void copy_into_arena(double* dest, const matrix_t* source) {
+    memcpy(dest, source->storage, (size_t)source->rows * source->stride * sizeof(double));
+}
 
-            if (read(temp_process.pipe_out[0], &element_result, sizeof(element_result)) == sizeof(element_result)) {
-                result->data[i][j] = element_result;
-                success_count++;
+// Lays out [C | A | B] in a fresh shared-memory arena, splits C into a grid
+// of roughly POOL_TILES_PER_WORKER tiles per worker and lets the pool compute
+// them in place. Only tile_job_t headers and status words cross the pipes.
+// On success the C region becomes the storage of the returned matrix and
+// *workers holds the number of workers used; NULL with *workers == -1 means
+// the pool could not be used.
+static matrix_t* run_tiled_operation(operation_type_t op, const matrix_t* A, const matrix_t* B,
+                                     int rows, int cols, const char* name, int* workers) {
+    *workers = -1;
+    int ldc = matrix_stride_for(cols);
+    size_t c_bytes = page_round((size_t)rows * ldc * sizeof(double));
+    size_t a_bytes = page_round((size_t)A->rows * A->stride * sizeof(double));
+    size_t b_bytes = (size_t)B->rows * B->stride * sizeof(double);
+    
+    shm_arena_t arena;
+    if (arena_create(&arena, c_bytes + a_bytes + b_bytes) != 0) {
+        printf("Shared memory arena unavailable\n");
+        return NULL;
+    }
+    size_t a_offset = c_bytes / sizeof(double);
+    size_t b_offset = (c_bytes + a_bytes) / sizeof(double);
+    long long span = trace_begin();
+    copy_into_arena(arena.base + a_offset, A);
+    copy_into_arena(arena.base + b_offset, B);
+    trace_end("arena_copy", span);
+    
+    int target = pool_size * POOL_TILES_PER_WORKER;
+    int grid_rows, grid_cols;
+    if (op == OP_MULTIPLY_TILE) {
+        split_tile_grid(target, rows, cols, &grid_rows, &grid_cols);
+    } else {
+        grid_rows = target < rows ? target : rows;
+        grid_cols = 1;
+    }
+    
+    tile_job_t* tiles = (tile_job_t*)calloc((size_t)grid_rows * grid_cols, sizeof(tile_job_t));
+    if (!tiles) {
+        munmap(arena.base, arena.size);
+        arena_unlink(&arena);
+        return NULL;
+    }
+    
+    int count = 0;
+    for (int r = 0; r < grid_rows; r++) {
+        int row_start = (int)((long)rows * r / grid_rows);
+        int row_end = (int)((long)rows * (r + 1) / grid_rows);
+        for (int c = 0; c < grid_cols; c++) {
+            int col_start = (int)((long)cols * c / grid_cols);
+            int col_end = (int)((long)cols * (c + 1) / grid_cols);
+            if (row_end <= row_start || col_end <= col_start) continue;
+            
+            tile_job_t* job = &tiles[count++];
+            job->op = op;
+            job->arena_id = arena.id;
+            job->arena_size = arena.size;
+            job->lda = A->stride;
+            job->ldb = B->stride;
+            job->ldc = ldc;
+            job->m = row_end - row_start;
+            job->n = col_end - col_start;
+            job->alpha = 1.0;
+            job->c_offset = (size_t)row_start * ldc + col_start;
+            if (op == OP_MULTIPLY_TILE) {
+                job->k = A->cols;
+                job->a_offset = a_offset + (size_t)row_start * A->stride;
+                job->b_offset = b_offset + col_start;
             } else {
-                result->data[i][j] = value1 + value2; // fallback
+                job->a_offset = a_offset + (size_t)row_start * A->stride + col_start;
+                job->b_offset = b_offset + (size_t)row_start * B->stride + col_start;
             }
         }
     }
     
+    int used[MAX_PROCESSES] = {0};
+    job_queue_t queue = { arena.base, tiles, 0, count, 0 };
+    *workers = run_job_queue(&queue, used);
+    free(tiles);
+    release_arena(&arena, used);
+    
+    // Keep the C region as the result. The operand pages have to be punched
+    // out of the shm object: while C stays mapped, unmapping them alone
+    // would keep them allocated in /dev/shm for the life of the result.
+    madvise((char*)arena.base + c_bytes, arena.size - c_bytes, MADV_REMOVE);
+    munmap((char*)arena.base + c_bytes, arena.size - c_bytes);
+    if (*workers < 0) {
+        munmap(arena.base, c_bytes);
+        return NULL;
+    }
+    
+    matrix_t* result = create_matrix_on_mapping(rows, cols, name, arena.base, ldc, c_bytes);
+    if (!result) {
+        munmap(arena.base, c_bytes);
+        *workers = -1;
+    }
+    return result;
+}
 
-    kill(temp_process.pid, SIGTERM);
-    waitpid(temp_process.pid, NULL, 0);
-    close(temp_process.pipe_in[1]);
-    close(temp_process.pipe_out[0]);
+matrix_t* add_matrices_parallel(const matrix_t* A, const matrix_t* B) {
+    if (!A || !B) return NULL;
+    
+    if (A->rows != B->rows || A->cols != B->cols) {
+        printf("Matrix dimensions don't match for parallel addition\n");
+        return NULL;
+    }
+    
+    int workers;
+    matrix_t* result = run_tiled_operation(OP_ADD_TILE, A, B, A->rows, A->cols,
+                                           "Addition_Result_Parallel", &workers);
+    if (!result) {
+        printf("Failed to obtain pool workers, using sequential\n");
+        return add_matrices_seq(A, B);
+    }
     
-    printf("Parallel addition: %d/%d elements\n", success_count, A->rows * A->cols);
+    if (pool_verbose) {
+        printf("Parallel addition: %d elements across %d workers\n", A->rows * A->cols, workers);
+    }
     return result;
 }
 
@@ -228,47 +658,17 @@ matrix_t* subtract_matrices_parallel(const matrix_t* A, const matrix_t* B) {
         return NULL;
     }
     
-    matrix_t* result = create_matrix(A->rows, A->cols, "Subtraction_Result_Parallel");
-    if (!result) return NULL;
-    
-
-    child_process_t temp_process;
-    if (create_single_process(&temp_process) != 0) {
-        printf("Failed to create temporary process, using sequential\n");
-        free_matrix(result);
+    int workers;
+    matrix_t* result = run_tiled_operation(OP_SUBTRACT_TILE, A, B, A->rows, A->cols,
+                                           "Subtraction_Result_Parallel", &workers);
+    if (!result) {
+        printf("Failed to obtain pool workers, using sequential\n");
         return subtract_matrices_seq(A, B);
     }
     
-    int success_count = 0;
-    
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < A->cols; j++) {
-            operation_type_t op_type = OP_SUBTRACT_ELEMENT;
-            double value1 = A->data[i][j];
-            double value2 = B->data[i][j];
-            double element_result;
-            
-            if (write(temp_process.pipe_in[1], &op_type, sizeof(op_type)) != sizeof(op_type) ||
-                write(temp_process.pipe_in[1], &value1, sizeof(value1)) != sizeof(value1) ||
-                write(temp_process.pipe_in[1], &value2, sizeof(value2)) != sizeof(value2)) {
-                continue;
-            }
-            
-            if (read(temp_process.pipe_out[0], &element_result, sizeof(element_result)) == sizeof(element_result)) {
-                result->data[i][j] = element_result;
-                success_count++;
-            } else {
-                result->data[i][j] = value1 - value2;
-            }
-        }
+    if (pool_verbose) {
+        printf("Parallel subtraction: %d elements across %d workers\n", A->rows * A->cols, workers);
     }
-    
-    kill(temp_process.pid, SIGTERM);
-    waitpid(temp_process.pid, NULL, 0);
-    close(temp_process.pipe_in[1]);
-    close(temp_process.pipe_out[0]);
-    
-    printf("Parallel subtraction: %d/%d elements\n", success_count, A->rows * A->cols);
     return result;
 }
 
@@ -280,56 +680,88 @@ matrix_t* multiply_matrices_parallel(const matrix_t* A, const matrix_t* B) {
         return NULL;
     }
     
-    matrix_t* result = create_matrix(A->rows, B->cols, "Multiplication_Result_Parallel");
-    if (!result) return NULL;
-    
-
-    child_process_t temp_process;
-    if (create_single_process(&temp_process) != 0) {
-        printf("Failed to create temporary process, using sequential\n");
-        free_matrix(result);
+    int workers;
+    matrix_t* result = run_tiled_operation(OP_MULTIPLY_TILE, A, B, A->rows, B->cols,
+                                           "Multiplication_Result_Parallel", &workers);
+    if (!result) {
+        printf("Failed to obtain pool workers, using sequential\n");
         return multiply_matrices_seq(A, B);
     }
     
-    int success_count = 0;
-    int total_operations = A->rows * B->cols * A->cols;
+    if (pool_verbose) {
+        printf("Parallel multiplication: %dx%d result across %d workers\n", result->rows, result->cols, workers);
+    }
+    return result;
+}
+
+// A 16 x 16 multiply is all fixed cost: arena setup, one round trip per
+// tile and teardown. Returns the number of workers used, -1 if none.
+int pool_probe(void) {
+    if (active_processes == 0) return -1;
+    matrix_t* A = create_matrix(16, 16, "Pool_Probe");
+    if (!A) return -1;
     
-    for (int i = 0; i < A->rows; i++) {
-        for (int j = 0; j < B->cols; j++) {
-            double sum = 0.0;
-            
-            for (int k = 0; k < A->cols; k++) {
-                operation_type_t op_type = OP_MULTIPLY_ELEMENT;
-                double value1 = A->data[i][k];
-                double value2 = B->data[k][j];
-                double element_result;
-                
-                if (write(temp_process.pipe_in[1], &op_type, sizeof(op_type)) != sizeof(op_type) ||
-                    write(temp_process.pipe_in[1], &value1, sizeof(value1)) != sizeof(value1) ||
-                    write(temp_process.pipe_in[1], &value2, sizeof(value2)) != sizeof(value2)) {
-                    sum += value1 * value2;
-                    continue;
-                }
-                
-                if (read(temp_process.pipe_out[0], &element_result, sizeof(element_result)) == sizeof(element_result)) {
-                    sum += element_result;
-                    success_count++;
-                } else {
-                    sum += value1 * value2;
-                }
-            }
+    int workers;
+    matrix_t* result = run_tiled_operation(OP_MULTIPLY_TILE, A, A, 16, 16, "Pool_Probe", &workers);
+    free_matrix(result);
+    free_matrix(A);
+    return workers;
+}
+
+typedef struct {
+    shm_arena_t* arena;
+    int used[MAX_PROCESSES];
+} lu_pool_context_t;
+
+// lu_update_fn for the pool: A22 -= L21 * U12 as a grid of accumulating
+// tiles, all addressed inside the arena holding the matrix being factored.
+static int lu_pool_update(void* context, int m, int n, int k,
+                          const double* L21, const double* U12, double* A22, int lda) {
+    lu_pool_context_t* lu = (lu_pool_context_t*)context;
+    double* base = lu->arena->base;
+    int grid_rows, grid_cols;
+    split_tile_grid(pool_size * POOL_TILES_PER_WORKER, m, n, &grid_rows, &grid_cols);
+    
+    tile_job_t* tiles = (tile_job_t*)calloc((size_t)grid_rows * grid_cols, sizeof(tile_job_t));
+    if (!tiles) {
+        gemm_compute(m, n, k, -1.0, L21, lda, U12, lda, A22, lda, 0);
+        return 0;
+    }
+    
+    int count = 0;
+    for (int r = 0; r < grid_rows; r++) {
+        int row_start = (int)((long)m * r / grid_rows);
+        int row_end = (int)((long)m * (r + 1) / grid_rows);
+        for (int c = 0; c < grid_cols; c++) {
+            int col_start = (int)((long)n * c / grid_cols);
+            int col_end = (int)((long)n * (c + 1) / grid_cols);
+            if (row_end <= row_start || col_end <= col_start) continue;
             
-            result->data[i][j] = sum;
+            tile_job_t* job = &tiles[count++];
+            job->op = OP_LU_UPDATE_TILE;
+            job->arena_id = lu->arena->id;
+            job->arena_size = lu->arena->size;
+            job->lda = lda;
+            job->ldb = lda;
+            job->ldc = lda;
+            job->m = row_end - row_start;
+            job->n = col_end - col_start;
+            job->k = k;
+            job->alpha = -1.0;
+            job->a_offset = (size_t)(L21 - base) + (size_t)row_start * lda;
+            job->b_offset = (size_t)(U12 - base) + col_start;
+            job->c_offset = (size_t)(A22 - base) + (size_t)row_start * lda + col_start;
         }
     }
     
-    kill(temp_process.pid, SIGTERM);
-    waitpid(temp_process.pid, NULL, 0);
-    close(temp_process.pipe_in[1]);
-    close(temp_process.pipe_out[0]);
-    
-    printf("Parallel multiplication: %d/%d operations\n", success_count, total_operations);
-    return result;
+    job_queue_t queue = { base, tiles, 0, count, 0 };
+    int workers = run_job_queue(&queue, lu->used);
+    free(tiles);
+    if (workers < 0) {
+        // No worker took a tile, so the whole update is still pending.
+        gemm_compute(m, n, k, -1.0, L21, lda, U12, lda, A22, lda, 0);
+    }
+    return queue.lost > 0 ? -1 : 0;
 }
 
 double matrix_determinant_parallel(const matrix_t* matrix) {
@@ -343,28 +775,53 @@ double matrix_determinant_parallel(const matrix_t* matrix) {
         return 0.0;
     }
 
-    return matrix_determinant_seq(matrix);
-}
-
-
-child_process_t* get_available_process() { 
-    return NULL; 
-}
-
-void return_process(child_process_t* process) { 
-    (void)process; 
+    int n = matrix->rows;
+    if (n < 2 * LU_BLOCK_SIZE) {
+        // A single trailing update is too small to be worth shipping out.
+        return matrix_determinant_seq(matrix);
+    }
+    
+    shm_arena_t arena;
+    if (arena_create(&arena, (size_t)n * matrix->stride * sizeof(double)) != 0) {
+        printf("Shared memory arena unavailable, using sequential\n");
+        return matrix_determinant_seq(matrix);
+    }
+    copy_into_arena(arena.base, matrix);
+    
+    lu_pool_context_t context;
+    memset(&context, 0, sizeof(context));
+    context.arena = &arena;
+    
+    // The panels and row-block solves stay in the parent; every trailing
+    // update is split into tiles for the pool.
+    double det = 0.0;
+    int status = lu_determinant_blocked(arena.base, n, matrix->stride, 0,
+                                        lu_pool_update, &context, &det);
+    release_arena(&arena, context.used);
+    munmap(arena.base, arena.size);
+    
+    if (status != 0) {
+        printf("Pool workers failed during the LU update, using sequential\n");
+        return matrix_determinant_seq(matrix);
+    }
+    
+    int workers = 0;
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        workers += context.used[i];
+    }
+    if (pool_verbose) {
+        printf("Parallel determinant: %dx%d blocked LU across %d workers\n", n, n, workers);
+    }
+    return det;
 }
 
 void cleanup_idle_processes() {
 
     time_t current_time = time(NULL);
-    for (int i = 0; i < global_config.max_processes; i++) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
         if (process_pool[i].pid > 0 && !process_pool[i].busy) {
             if (current_time - process_pool[i].last_used > PROCESS_TIMEOUT) {
-                kill(process_pool[i].pid, SIGTERM);
-                waitpid(process_pool[i].pid, NULL, 0);
-                process_pool[i].pid = -1;
-                active_processes--;
+                stop_worker(&process_pool[i]);
             }
         }
     }
@@ -379,5 +836,5 @@ int create_worker_process(child_process_t* process) {
 }
 
 void worker_process_main(int pipe_in, int pipe_out) { 
-    worker_simple_calculation(pipe_in, pipe_out);
+    worker_tile_calculation(pipe_in, pipe_out);
 }
@@ -0,0 +1,288 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/result_cache.h"
+#include "../include/config.h"
+
+typedef struct cache_entry {
+    cache_key_t key;
+    unsigned hash;
+    double determinant;
+    matrix_t* matrix;
+    eigen_t* eigenvalues;
+    int eigen_count;
+    int eigen_n;
+    size_t bytes;
+    struct cache_entry* chain_next;
+    struct cache_entry* lru_prev;   // towards the most recently used entry
+    struct cache_entry* lru_next;   // towards the least recently used entry
+} cache_entry_t;
+
+// Chained hash table over the entries plus an LRU list threaded through
+// them; lru_head is the most recently used entry and lru_tail the next
+// to be evicted.
+static cache_entry_t** buckets = NULL;
+static int bucket_count = 0;
+static cache_entry_t* lru_head = NULL;
+static cache_entry_t* lru_tail = NULL;
+static result_cache_stats_t stats;
+
+cache_key_t result_cache_key(cache_op_t op, int variant, int param,
+                             const matrix_t* A, const matrix_t* B) {
+    cache_key_t key;
+    memset(&key, 0, sizeof(key));
+    key.op = op;
+    key.variant = variant;
+    key.param = param;
+    key.a_id = A->id;
+    key.a_version = A->version;
+    if (B) {
+        key.b_id = B->id;
+        key.b_version = B->version;
+    }
+    return key;
+}
+
+static unsigned hash_mix(unsigned hash, unsigned long value) {
+    for (int i = 0; i < (int)sizeof(value); i++) {
+        hash ^= (unsigned)(value & 0xff);
+        hash *= 16777619u;
+        value >>= 8;
+    }
+    return hash;
+}
+
+static unsigned hash_key(const cache_key_t* key) {
+    unsigned hash = 2166136261u;
+    hash = hash_mix(hash, (unsigned long)key->op);
+    hash = hash_mix(hash, (unsigned long)key->variant);
+    hash = hash_mix(hash, (unsigned long)key->param);
+    hash = hash_mix(hash, (unsigned long)key->a_id);
+    hash = hash_mix(hash, key->a_version);
+    hash = hash_mix(hash, (unsigned long)key->b_id);
+    hash = hash_mix(hash, key->b_version);
+    return hash;
+}
+
+static int keys_equal(const cache_key_t* a, const cache_key_t* b) {
+    return a->op == b->op && a->variant == b->variant && a->param == b->param &&
+           a->a_id == b->a_id && a->a_version == b->a_version &&
+           a->b_id == b->b_id && a->b_version == b->b_version;
+}
+
+static void lru_unlink(cache_entry_t* entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else lru_tail = entry->lru_prev;
+}
+
+static void lru_push_front(cache_entry_t* entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = lru_head;
+    if (lru_head) lru_head->lru_prev = entry;
+    lru_head = entry;
+    if (!lru_tail) lru_tail = entry;
+}
+
+static void remove_entry(cache_entry_t* entry) {
+    cache_entry_t** link = &buckets[entry->hash & (unsigned)(bucket_count - 1)];
+    while (*link != entry) link = &(*link)->chain_next;
+    *link = entry->chain_next;
+    lru_unlink(entry);
+
+    free_matrix(entry->matrix);
+    free_eigen_results(entry->eigenvalues, entry->eigen_count);
+    stats.entries--;
+    stats.bytes -= entry->bytes;
+    free(entry);
+}
+
+static cache_entry_t* lookup(const cache_key_t* key) {
+    if (bucket_count == 0) {
+        stats.misses++;
+        return NULL;
+    }
+    unsigned hash = hash_key(key);
+    cache_entry_t* entry = buckets[hash & (unsigned)(bucket_count - 1)];
+    while (entry && !(entry->hash == hash && keys_equal(&entry->key, key))) {
+        entry = entry->chain_next;
+    }
+    if (!entry) {
+        stats.misses++;
+        return NULL;
+    }
+    stats.hits++;
+    lru_unlink(entry);
+    lru_push_front(entry);
+    return entry;
+}
+
+static int grow_buckets(void) {
+    int count = bucket_count ? bucket_count * 2 : 64;
+    cache_entry_t** grown = (cache_entry_t**)calloc((size_t)count, sizeof(cache_entry_t*));
+    if (!grown) return -1;
+    for (cache_entry_t* entry = lru_head; entry; entry = entry->lru_next) {
+        unsigned b = entry->hash & (unsigned)(count - 1);
+        entry->chain_next = grown[b];
+        grown[b] = entry;
+    }
+    free(buckets);
+    buckets = grown;
+    bucket_count = count;
+    return 0;
+}
+
+// Makes room for an entry of the given size. Returns -1 when the result
+// should not be cached at all.
+static int reserve(size_t bytes) {
+    int limit = global_config.cache_size;
+    if (limit <= 0 || bytes > RESULT_CACHE_MAX_BYTES) return -1;
+    while (lru_tail && (stats.entries >= limit || stats.bytes + bytes > RESULT_CACHE_MAX_BYTES)) {
+        remove_entry(lru_tail);
+        stats.evictions++;
+    }
+    if (stats.entries + 1 > bucket_count && grow_buckets() != 0) return -1;
+    return 0;
+}
+
+// Takes ownership of entry, which must not already be cached.
+static void insert(const cache_key_t* key, cache_entry_t* entry) {
+    entry->key = *key;
+    entry->hash = hash_key(key);
+    unsigned b = entry->hash & (unsigned)(bucket_count - 1);
+    entry->chain_next = buckets[b];
+    buckets[b] = entry;
+    lru_push_front(entry);
+    stats.entries++;
+    stats.bytes += entry->bytes;
+}
+
+static cache_entry_t* new_entry(const cache_key_t* key, size_t bytes) {
+    // A put for a key that is already cached replaces the old result.
+    if (bucket_count > 0) {
+        unsigned hash = hash_key(key);
+        cache_entry_t* entry = buckets[hash & (unsigned)(bucket_count - 1)];
+        while (entry && !(entry->hash == hash && keys_equal(&entry->key, key))) {
+            entry = entry->chain_next;
+        }
+        if (entry) remove_entry(entry);
+    }
+    if (reserve(bytes) != 0) return NULL;
+    cache_entry_t* entry = (cache_entry_t*)calloc(1, sizeof(cache_entry_t));
+    if (entry) entry->bytes = bytes;
+    return entry;
+}
+
+int result_cache_get_determinant(const cache_key_t* key, double* det) {
+    cache_entry_t* entry = lookup(key);
+    if (!entry) return -1;
+    *det = entry->determinant;
+    return 0;
+}
+
+void result_cache_put_determinant(const cache_key_t* key, double det) {
+    cache_entry_t* entry = new_entry(key, sizeof(double));
+    if (!entry) return;
+    entry->determinant = det;
+    insert(key, entry);
+}
+
+matrix_t* result_cache_get_matrix(const cache_key_t* key) {
+    cache_entry_t* entry = lookup(key);
+    return entry ? copy_matrix(entry->matrix) : NULL;
+}
+
+void result_cache_put_matrix(const cache_key_t* key, const matrix_t* result) {
+    size_t bytes = (size_t)result->rows * matrix_stride_for(result->cols) * sizeof(double);
+    cache_entry_t* entry = new_entry(key, bytes);
+    if (!entry) return;
+    entry->matrix = copy_matrix(result);
+    if (!entry->matrix) {
+        free(entry);
+        return;
+    }
+    insert(key, entry);
+}
+
+static double* copy_vector(const double* v, int n) {
+    if (!v) return NULL;
+    double* copy = (double*)malloc((size_t)n * sizeof(double));
+    if (copy) memcpy(copy, v, (size_t)n * sizeof(double));
+    return copy;
+}
+
+// Deep copy of count eigenpairs with vectors of length n; NULL on failure.
+static eigen_t* copy_eigen_results(const eigen_t* eigenvalues, int count, int n) {
+    eigen_t* copy = (eigen_t*)calloc((size_t)count, sizeof(eigen_t));
+    if (!copy) return NULL;
+    for (int i = 0; i < count; i++) {
+        copy[i].eigenvalue = eigenvalues[i].eigenvalue;
+        copy[i].eigenvalue_imag = eigenvalues[i].eigenvalue_imag;
+        copy[i].eigenvector = copy_vector(eigenvalues[i].eigenvector, n);
+        copy[i].eigenvector_imag = copy_vector(eigenvalues[i].eigenvector_imag, n);
+        if ((eigenvalues[i].eigenvector && !copy[i].eigenvector) ||
+            (eigenvalues[i].eigenvector_imag && !copy[i].eigenvector_imag)) {
+            free_eigen_results(copy, i + 1);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+int result_cache_get_eigen(const cache_key_t* key, eigen_t** eigenvalues, int* count) {
+    cache_entry_t* entry = lookup(key);
+    if (!entry) return -1;
+    *eigenvalues = copy_eigen_results(entry->eigenvalues, entry->eigen_count, entry->eigen_n);
+    if (!*eigenvalues) return -1;
+    *count = entry->eigen_count;
+    return 0;
+}
+
+void result_cache_put_eigen(const cache_key_t* key, const eigen_t* eigenvalues,
+                            int count, int n) {
+    size_t bytes = (size_t)count * (sizeof(eigen_t) + 2 * (size_t)n * sizeof(double));
+    cache_entry_t* entry = new_entry(key, bytes);
+    if (!entry) return;
+    entry->eigenvalues = copy_eigen_results(eigenvalues, count, n);
+    if (!entry->eigenvalues) {
+        free(entry);
+        return;
+    }
+    entry->eigen_count = count;
+    entry->eigen_n = n;
+    insert(key, entry);
+}
+
+void result_cache_invalidate(int matrix_id) {
+    cache_entry_t* entry = lru_head;
+    while (entry) {
+        cache_entry_t* next = entry->lru_next;
+        if (entry->key.a_id == matrix_id || entry->key.b_id == matrix_id) {
+            remove_entry(entry);
+            stats.invalidations++;
+        }
+        entry = next;
+    }
+}
+
+void result_cache_clear(void) {
+    while (lru_head) remove_entry(lru_head);
+    free(buckets);
+    buckets = NULL;
+    bucket_count = 0;
+}
+
+void result_cache_get_stats(result_cache_stats_t* out) {
+    *out = stats;
+}
+
+void result_cache_print_stats(void) {
+    unsigned long lookups = stats.hits + stats.misses;
+    printf("Result cache: %d/%d entries, %.1f MB, %lu hits, %lu misses (%.1f%% hit rate), "
+           "%lu evictions, %lu invalidations\n",
+           stats.entries, global_config.cache_size, (double)stats.bytes / (1024.0 * 1024.0),
+           stats.hits, stats.misses, lookups ? 100.0 * stats.hits / lookups : 0.0,
+           stats.evictions, stats.invalidations);
+}
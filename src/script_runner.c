@@ -0,0 +1,465 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include "../include/script_runner.h"
+#include "../include/config.h"
+#include "../include/matrix_operations.h"
+#include "../include/file_operations.h"
+#include "../include/dispatcher.h"
+#include "../include/result_cache.h"
+#include "../include/expression.h"
+
+#define SCRIPT_NAME_SIZE 50   // matches matrix_t.name
+
+// One parsed command; which fields are used depends on op.
+typedef struct {
+    char op[16];
+    char out[SCRIPT_NAME_SIZE];
+    char a[SCRIPT_NAME_SIZE];
+    char b[SCRIPT_NAME_SIZE];
+    char path[MAX_FILENAME];
+    char engine[16];
+    char expr[SCRIPT_MAX_LINE];
+    int rows;
+    int cols;
+    int k;
+} script_command_t;
+
+typedef struct {
+    const char* source;
+    int line;
+    FILE* results;
+    engine_t engine;
+    const char* ran_on;   // engine or "cached", for the timing line
+} script_state_t;
+
+static void script_error(const script_state_t* state, const char* format, ...) {
+    va_list args;
+    fprintf(stderr, "%s:%d: ", state->source, state->line);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+// Copies value into dest, truncating to size - 1 characters.
+static void copy_field(char* dest, size_t size, const char* value) {
+    size_t length = strlen(value);
+    if (length >= size) length = size - 1;
+    memcpy(dest, value, length);
+    dest[length] = '\0';
+}
+
+// Positional words: the op, then its operands in the order of the
+// command table in script_runner.h.
+static int parse_words(char* line, script_command_t* command) {
+    char* words[6];
+    int count = 0;
+    for (char* word = strtok(line, " \t\r"); word && count < 6; word = strtok(NULL, " \t\r")) {
+        words[count++] = word;
+        // eval takes the rest of the line after its output as one word.
+        if (count == 2 && strcmp(words[0], "eval") == 0) {
+            char* rest = strtok(NULL, "\r");
+            if (rest) words[count++] = rest;
+            break;
+        }
+    }
+    if (count == 0) return -1;
+
+    const char* op = words[0];
+    copy_field(command->op, sizeof(command->op), op);
+    if (strcmp(op, "load") == 0 || strcmp(op, "save") == 0) {
+        if (count != 3) return -1;
+        copy_field(strcmp(op, "load") == 0 ? command->out : command->a, SCRIPT_NAME_SIZE, words[1]);
+        copy_field(command->path, sizeof(command->path), words[2]);
+    } else if (strcmp(op, "random") == 0) {
+        if (count != 4) return -1;
+        copy_field(command->out, sizeof(command->out), words[1]);
+        command->rows = atoi(words[2]);
+        command->cols = atoi(words[3]);
+    } else if (strcmp(op, "add") == 0 || strcmp(op, "sub") == 0 || strcmp(op, "mul") == 0) {
+        if (count != 4) return -1;
+        copy_field(command->out, sizeof(command->out), words[1]);
+        copy_field(command->a, sizeof(command->a), words[2]);
+        copy_field(command->b, sizeof(command->b), words[3]);
+    } else if (strcmp(op, "transpose") == 0) {
+        if (count != 3) return -1;
+        copy_field(command->out, sizeof(command->out), words[1]);
+        copy_field(command->a, sizeof(command->a), words[2]);
+    } else if (strcmp(op, "det") == 0 || strcmp(op, "free") == 0) {
+        if (count != 2) return -1;
+        copy_field(command->a, sizeof(command->a), words[1]);
+    } else if (strcmp(op, "eig") == 0) {
+        if (count != 2 && count != 3) return -1;
+        copy_field(command->a, sizeof(command->a), words[1]);
+        if (count == 3) command->k = atoi(words[2]);
+    } else if (strcmp(op, "eval") == 0) {
+        if (count != 3) return -1;
+        copy_field(command->out, sizeof(command->out), words[1]);
+        copy_field(command->expr, sizeof(command->expr), words[2]);
+    } else if (strcmp(op, "engine") == 0) {
+        if (count != 2) return -1;
+        copy_field(command->engine, sizeof(command->engine), words[1]);
+    }
+    return 0;
+}
+
+static const char* skip_space(const char* p) {
+    while (isspace((unsigned char)*p)) p++;
+    return p;
+}
+
+// A JSON string into out (truncated to size); \uXXXX escapes outside
+// ASCII become '?'. Returns the position after the closing quote.
+static const char* parse_json_string(const char* p, char* out, size_t size) {
+    if (*p != '"') return NULL;
+    p++;
+    size_t length = 0;
+    while (*p && *p != '"') {
+        char c = *p++;
+        if (c == '\\') {
+            char e = *p++;
+            switch (e) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; i++) {
+                        if (!isxdigit((unsigned char)*p)) return NULL;
+                        char digit = *p++;
+                        code = code * 16 + (unsigned)(isdigit((unsigned char)digit) ? digit - '0'
+                                                                   : tolower((unsigned char)digit) - 'a' + 10);
+                    }
+                    c = code < 128 ? (char)code : '?';
+                    break;
+                }
+                case '\0': return NULL;
+                default: c = e; break;   // \" \\ \/
+            }
+        }
+        if (length + 1 < size) out[length++] = c;
+    }
+    if (*p != '"') return NULL;
+    out[length] = '\0';
+    return p + 1;
+}
+
+static void set_json_field(script_command_t* command, const char* key, const char* text) {
+    if (strcmp(key, "op") == 0) copy_field(command->op, sizeof(command->op), text);
+    else if (strcmp(key, "out") == 0 || strcmp(key, "name") == 0) copy_field(command->out, sizeof(command->out), text);
+    else if (strcmp(key, "a") == 0) copy_field(command->a, sizeof(command->a), text);
+    else if (strcmp(key, "b") == 0) copy_field(command->b, sizeof(command->b), text);
+    else if (strcmp(key, "path") == 0) copy_field(command->path, sizeof(command->path), text);
+    else if (strcmp(key, "engine") == 0) copy_field(command->engine, sizeof(command->engine), text);
+    else if (strcmp(key, "expr") == 0) copy_field(command->expr, sizeof(command->expr), text);
+    else if (strcmp(key, "rows") == 0) command->rows = atoi(text);
+    else if (strcmp(key, "cols") == 0) command->cols = atoi(text);
+    else if (strcmp(key, "k") == 0) command->k = atoi(text);
+    // Unknown keys are ignored so producers can attach their own tags.
+}
+
+// One flat JSON object with string, number, boolean or null values.
+static int parse_json(const char* line, script_command_t* command) {
+    const char* p = skip_space(line);
+    if (*p++ != '{') return -1;
+    p = skip_space(p);
+    if (*p == '}') return 0;
+
+    while (1) {
+        char key[32], value[SCRIPT_MAX_LINE];
+        p = parse_json_string(skip_space(p), key, sizeof(key));
+        if (!p) return -1;
+        p = skip_space(p);
+        if (*p++ != ':') return -1;
+        p = skip_space(p);
+        if (*p == '"') {
+            p = parse_json_string(p, value, sizeof(value));
+            if (!p) return -1;
+        } else {
+            size_t length = 0;
+            while (*p && *p != ',' && *p != '}' && !isspace((unsigned char)*p)) {
+                if (length + 1 < sizeof(value)) value[length++] = *p;
+                p++;
+            }
+            if (length == 0) return -1;
+            value[length] = '\0';
+        }
+        set_json_field(command, key, value);
+
+        p = skip_space(p);
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        if (*p == '}') break;
+        return -1;
+    }
+    // "name" is the matrix a command works on when it has no output.
+    if (!command->a[0] && command->out[0] &&
+        (strcmp(command->op, "det") == 0 || strcmp(command->op, "eig") == 0 ||
+         strcmp(command->op, "save") == 0 || strcmp(command->op, "free") == 0)) {
+        copy_field(command->a, sizeof(command->a), command->out);
+    }
+    return 0;
+}
+
+static matrix_t* operand(const script_state_t* state, const char* name) {
+    matrix_t* matrix = find_matrix_by_name(name);
+    if (!matrix) script_error(state, "no matrix named '%s'", name);
+    return matrix;
+}
+
+// Registers result under name, replacing any matrix already called that.
+static int store_result(const script_state_t* state, const char* name, matrix_t* result) {
+    copy_field(result->name, sizeof(result->name), name);
+    matrix_t* previous = find_matrix_by_name(name);
+    if (previous) release_matrix(previous->id);
+    if (add_matrix_to_registry(result) < 0) {
+        free_matrix(result);
+        script_error(state, "cannot register '%s'", name);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_engine(const char* name, engine_t* engine) {
+    static const struct { const char* name; engine_t engine; } engines[] = {
+        { "auto", ENGINE_AUTO }, { "sequential", ENGINE_SEQUENTIAL },
+        { "processes", ENGINE_PROCESSES }, { "openmp", ENGINE_OPENMP }
+    };
+    for (size_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++) {
+        if (strcmp(name, engines[i].name) == 0) {
+            *engine = engines[i].engine;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int run_binary(script_state_t* state, const script_command_t* command) {
+    matrix_t* A = operand(state, command->a);
+    matrix_t* B = operand(state, command->b);
+    if (!A || !B) return -1;
+
+    dispatch_op_t op = DISPATCH_MULTIPLY;
+    cache_op_t cache_op = CACHE_OP_MULTIPLY;
+    if (strcmp(command->op, "add") == 0) {
+        op = DISPATCH_ADD;
+        cache_op = CACHE_OP_ADD;
+    } else if (strcmp(command->op, "sub") == 0) {
+        op = DISPATCH_SUBTRACT;
+        cache_op = CACHE_OP_SUBTRACT;
+    }
+
+    cache_key_t key = result_cache_key(cache_op, 0, 0, A, B);
+    matrix_t* result = result_cache_get_matrix(&key);
+    state->ran_on = "cached";
+    if (!result) {
+        engine_t used;
+        result = dispatch_binary(op, state->engine, A, B, &used);
+        if (!result) {
+            script_error(state, "%s of %dx%d and %dx%d failed", command->op,
+                         A->rows, A->cols, B->rows, B->cols);
+            return -1;
+        }
+        state->ran_on = engine_name(used);
+        result_cache_put_matrix(&key, result);
+    }
+    return store_result(state, command->out, result);
+}
+
+static int run_determinant(script_state_t* state, const script_command_t* command) {
+    matrix_t* matrix = operand(state, command->a);
+    if (!matrix) return -1;
+    if (matrix->rows != matrix->cols) {
+        script_error(state, "det needs a square matrix, '%s' is %dx%d", matrix->name, matrix->rows, matrix->cols);
+        return -1;
+    }
+
+    cache_key_t key = result_cache_key(CACHE_OP_DETERMINANT, 0, 0, matrix, NULL);
+    double det;
+    state->ran_on = "cached";
+    if (result_cache_get_determinant(&key, &det) != 0) {
+        engine_t used;
+        det = dispatch_determinant(state->engine, matrix, &used);
+        state->ran_on = engine_name(used);
+        result_cache_put_determinant(&key, det);
+    }
+    fprintf(state->results, "det %s %.17g\n", command->a, det);
+    return 0;
+}
+
+// Routed by find_eigenvalues_auto, sharing its cache entries with the menu
+// and the server.
+static int run_eigen(script_state_t* state, const script_command_t* command) {
+    matrix_t* matrix = operand(state, command->a);
+    if (!matrix) return -1;
+    if (matrix->rows != matrix->cols) {
+        script_error(state, "eig needs a square matrix, '%s' is %dx%d", matrix->name, matrix->rows, matrix->cols);
+        return -1;
+    }
+    if (command->k < 0 || command->k > matrix->rows) {
+        script_error(state, "eig k must be between 1 and %d", matrix->rows);
+        return -1;
+    }
+
+    int variant = command->k > 0 ? CACHE_EIGEN_TOP_K : CACHE_EIGEN_AUTO;
+    cache_key_t key = result_cache_key(CACHE_OP_EIGEN, variant, command->k, matrix, NULL);
+    eigen_t* eigenvalues = NULL;
+    int count = 0;
+    state->ran_on = "cached";
+    if (result_cache_get_eigen(&key, &eigenvalues, &count) != 0) {
+        int status = find_eigenvalues_auto(matrix, command->k, &eigenvalues, &count, &state->ran_on);
+        if (status != 0 || !eigenvalues) {
+            script_error(state, "eigen solver failed on '%s'", matrix->name);
+            return -1;
+        }
+        result_cache_put_eigen(&key, eigenvalues, count, matrix->rows);
+    }
+
+    fprintf(state->results, "eig %s %d", command->a, count);
+    for (int i = 0; i < count; i++) {
+        if (eigenvalues[i].eigenvalue_imag != 0.0) {
+            fprintf(state->results, " %.17g%+.17gi", eigenvalues[i].eigenvalue, eigenvalues[i].eigenvalue_imag);
+        } else {
+            fprintf(state->results, " %.17g", eigenvalues[i].eigenvalue);
+        }
+    }
+    fprintf(state->results, "\n");
+    free_eigen_results(eigenvalues, count);
+    return 0;
+}
+
+static int run_save(script_state_t* state, const script_command_t* command) {
+    matrix_t* matrix = operand(state, command->a);
+    if (!matrix) return -1;
+    const char* extension = strrchr(command->path, '.');
+    int status = extension && strcmp(extension, ".mat") == 0 ? write_matrix_binary(matrix, command->path)
+                                                             : write_matrix_text(matrix, command->path);
+    if (status != 0) {
+        script_error(state, "cannot write '%s'", command->path);
+        return -1;
+    }
+    return 0;
+}
+
+// Element-wise chains run fused in one pass; products go through the
+// dispatcher as usual.
+static int run_eval(script_state_t* state, const script_command_t* command) {
+    char error[128];
+    expr_graph_t* graph = expr_graph_create();
+    const expr_t* root = graph ? expr_parse(graph, command->expr, error, sizeof(error)) : NULL;
+    if (!root) {
+        script_error(state, "%s", graph ? error : "out of memory");
+        expr_graph_free(graph);
+        return -1;
+    }
+    matrix_t* result = expr_evaluate(graph, root, command->out);
+    expr_graph_free(graph);
+    if (!result) {
+        script_error(state, "cannot evaluate '%s'", command->expr);
+        return -1;
+    }
+    state->ran_on = "fused";
+    return store_result(state, command->out, result);
+}
+
+static int execute(script_state_t* state, const script_command_t* command) {
+    const char* op = command->op;
+    state->ran_on = NULL;
+
+    if (strcmp(op, "add") == 0 || strcmp(op, "sub") == 0 || strcmp(op, "mul") == 0) {
+        return run_binary(state, command);
+    }
+    if (strcmp(op, "det") == 0) return run_determinant(state, command);
+    if (strcmp(op, "eig") == 0) return run_eigen(state, command);
+    if (strcmp(op, "save") == 0) return run_save(state, command);
+    if (strcmp(op, "eval") == 0) return run_eval(state, command);
+
+    if (strcmp(op, "load") == 0) {
+        matrix_t* matrix = read_matrix_quiet(command->path);
+        if (!matrix) {
+            script_error(state, "cannot load '%s'", command->path);
+            return -1;
+        }
+        return store_result(state, command->out, matrix);
+    }
+    if (strcmp(op, "random") == 0) {
+        if (command->rows <= 0 || command->cols <= 0 ||
+            command->rows > MATRIX_MAX_DIMENSION || command->cols > MATRIX_MAX_DIMENSION) {
+            script_error(state, "invalid size %dx%d", command->rows, command->cols);
+            return -1;
+        }
+        matrix_t* matrix = create_random_matrix(command->rows, command->cols, command->out);
+        return matrix ? store_result(state, command->out, matrix) : -1;
+    }
+    if (strcmp(op, "transpose") == 0) {
+        matrix_t* matrix = operand(state, command->a);
+        if (!matrix) return -1;
+        matrix_t* result = matrix_transpose(matrix);
+        return result ? store_result(state, command->out, result) : -1;
+    }
+    if (strcmp(op, "free") == 0) {
+        matrix_t* matrix = operand(state, command->a);
+        if (!matrix) return -1;
+        release_matrix(matrix->id);
+        return 0;
+    }
+    if (strcmp(op, "engine") == 0) {
+        if (parse_engine(command->engine, &state->engine) != 0) {
+            script_error(state, "unknown engine '%s' (auto, sequential, processes, openmp)", command->engine);
+            return -1;
+        }
+        return 0;
+    }
+
+    script_error(state, "unknown command '%s'", op);
+    return -1;
+}
+
+int script_run(FILE* input, const char* source, FILE* results) {
+    script_state_t state = { source, 0, results, ENGINE_AUTO, NULL };
+    char line[SCRIPT_MAX_LINE];
+    int executed = 0, failed = 0;
+    double started = monotonic_seconds();
+
+    while (fgets(line, sizeof(line), input)) {
+        state.line++;
+        line[strcspn(line, "\n")] = '\0';
+        const char* text = skip_space(line);
+        if (*text == '\0' || *text == '#') continue;
+
+        script_command_t command;
+        memset(&command, 0, sizeof(command));
+        int parsed = *text == '{' ? parse_json(text, &command) : parse_words(line, &command);
+        if (parsed != 0 || !command.op[0]) {
+            script_error(&state, "cannot parse command");
+            failed++;
+            continue;
+        }
+
+        double start = monotonic_seconds();
+        int status = execute(&state, &command);
+        double elapsed = monotonic_seconds() - start;
+        executed++;
+        if (status != 0) {
+            failed++;
+        } else if (global_config.show_timings) {
+            fprintf(stderr, "%s:%d: %s %.6f s%s%s\n", source, state.line, command.op, elapsed,
+                    state.ran_on ? " " : "", state.ran_on ? state.ran_on : "");
+        }
+    }
+
+    double total = monotonic_seconds() - started;
+    fflush(results);
+    fprintf(stderr, "%d command(s), %d failed, %.3f s", executed, failed, total);
+    if (total > 0.0) fprintf(stderr, " (%.0f commands/s)", executed / total);
+    fprintf(stderr, "\n");
+    return failed;
+}
@@ -0,0 +1,514 @@
+#define _GNU_SOURCE   // memfd_create, accept4, MSG_CMSG_CLOEXEC
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/server.h"
+#include "../include/config.h"
+#include "../include/matrix_operations.h"
+#include "../include/dispatcher.h"
+#include "../include/result_cache.h"
+#include "../include/trace.h"
+
+// Requests taken from one client per wakeup before the others get a turn.
+#define SERVER_BURST 32
+#define SERVER_EPOLL_EVENTS 64
+// Seals that let a PUT payload be mapped in place (see server.h).
+#define SERVER_PAYLOAD_SEALS (F_SEAL_SHRINK | F_SEAL_WRITE)
+
+static volatile sig_atomic_t stop_requested = 0;
+static int clients[SERVER_MAX_CLIENTS];   // connected sockets, -1 when free
+static int client_count = 0;
+
+static struct {
+    unsigned long requests;
+    unsigned long failures;
+    unsigned long connections;
+    int peak_clients;
+    double busy_seconds;
+} stats;
+
+static void stop_handler(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static matrix_t* operand(int id, server_response_t* response) {
+    matrix_t* matrix = find_matrix_by_id(id);
+    if (!matrix) response->status = SERVER_E_NOT_FOUND;
+    return matrix;
+}
+
+static void describe(const matrix_t* matrix, server_response_t* response) {
+    response->id = matrix->id;
+    response->rows = matrix->rows;
+    response->cols = matrix->cols;
+    response->stride = matrix->stride;
+}
+
+static void register_result(matrix_t* result, const server_request_t* request,
+                            server_response_t* response) {
+    if (request->name[0]) {
+        memcpy(result->name, request->name, SERVER_NAME_SIZE);
+        result->name[SERVER_NAME_SIZE - 1] = '\0';
+    }
+    if (add_matrix_to_registry(result) < 0) {
+        free_matrix(result);
+        response->status = SERVER_E_FAILED;
+        return;
+    }
+    describe(result, response);
+}
+
+// A sealed memfd holding a copy of bytes from data, so clients can map it
+// without trusting each other or the server to leave it alone.
+static int payload_fd(const void* data, size_t bytes) {
+    int fd = memfd_create("matrix_ops", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return -1;
+    const char* p = (const char*)data;
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t written = write(fd, p + done, bytes - done);
+        if (written <= 0) {
+            close(fd);
+            return -1;
+        }
+        done += (size_t)written;
+    }
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    return fd;
+}
+
+// Copies an unsealed payload row by row. pread reports a payload that
+// was truncated meanwhile as a short read instead of faulting.
+static matrix_t* copy_payload(const server_request_t* request, int fd) {
+    matrix_t* matrix = create_matrix(request->rows, request->cols, "client");
+    if (!matrix) return NULL;
+    size_t row_bytes = (size_t)request->cols * sizeof(double);
+    for (int i = 0; i < request->rows; i++) {
+        char* row = (char*)MATRIX_ROW(matrix, i);
+        off_t offset = (off_t)i * request->stride * (off_t)sizeof(double);
+        size_t done = 0;
+        while (done < row_bytes) {
+            ssize_t got = pread(fd, row + done, row_bytes - done, offset + (off_t)done);
+            if (got <= 0) {
+                free_matrix(matrix);
+                return NULL;
+            }
+            done += (size_t)got;
+        }
+    }
+    return matrix;
+}
+
+// A payload sealed against shrinking and writing is mapped privately as
+// the storage of the new matrix, without copying: it can neither vanish
+// under the mapping (SIGBUS) nor change behind the result cache. Anything
+// else is copied.
+static void serve_put(const server_request_t* request, int fd, server_response_t* response) {
+    if (fd < 0 || request->rows <= 0 || request->cols <= 0 || request->stride < request->cols ||
+        request->rows > MATRIX_MAX_DIMENSION || request->stride > MATRIX_MAX_DIMENSION) {
+        response->status = SERVER_E_ARGUMENT;
+        return;
+    }
+    size_t bytes = (size_t)request->rows * (size_t)request->stride * sizeof(double);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < bytes) {
+        response->status = SERVER_E_ARGUMENT;
+        return;
+    }
+
+    matrix_t* matrix;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals >= 0 && (seals & SERVER_PAYLOAD_SEALS) == SERVER_PAYLOAD_SEALS) {
+        void* storage = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (storage == MAP_FAILED) {
+            response->status = SERVER_E_FAILED;
+            return;
+        }
+        matrix = create_matrix_on_mapping(request->rows, request->cols, "client",
+                                          (double*)storage, request->stride, bytes);
+        if (!matrix) munmap(storage, bytes);
+    } else {
+        matrix = copy_payload(request, fd);
+    }
+    if (!matrix) {
+        response->status = SERVER_E_FAILED;
+        return;
+    }
+    register_result(matrix, request, response);
+}
+
+static void serve_binary(const server_request_t* request, server_response_t* response) {
+    matrix_t* A = operand(request->a, response);
+    matrix_t* B = A ? operand(request->b, response) : NULL;
+    if (!B) return;
+
+    dispatch_op_t op = DISPATCH_MULTIPLY;
+    cache_op_t cache_op = CACHE_OP_MULTIPLY;
+    int fits = A->cols == B->rows;
+    if (request->op != SERVER_OP_MULTIPLY) {
+        op = request->op == SERVER_OP_ADD ? DISPATCH_ADD : DISPATCH_SUBTRACT;
+        cache_op = request->op == SERVER_OP_ADD ? CACHE_OP_ADD : CACHE_OP_SUBTRACT;
+        fits = A->rows == B->rows && A->cols == B->cols;
+    }
+    if (!fits) {
+        response->status = SERVER_E_ARGUMENT;
+        return;
+    }
+
+    cache_key_t key = result_cache_key(cache_op, 0, 0, A, B);
+    matrix_t* result = result_cache_get_matrix(&key);
+    response->engine = -1;
+    if (!result) {
+        engine_t used;
+        result = dispatch_binary(op, (engine_t)request->engine, A, B, &used);
+        if (!result) {
+            response->status = SERVER_E_FAILED;
+            return;
+        }
+        response->engine = used;
+        result_cache_put_matrix(&key, result);
+    }
+    register_result(result, request, response);
+}
+
+static void serve_determinant(const server_request_t* request, server_response_t* response) {
+    matrix_t* matrix = operand(request->a, response);
+    if (!matrix) return;
+    if (matrix->rows != matrix->cols) {
+        response->status = SERVER_E_ARGUMENT;
+        return;
+    }
+    cache_key_t key = result_cache_key(CACHE_OP_DETERMINANT, 0, 0, matrix, NULL);
+    response->engine = -1;
+    if (result_cache_get_determinant(&key, &response->value) != 0) {
+        engine_t used;
+        response->value = dispatch_determinant((engine_t)request->engine, matrix, &used);
+        response->engine = used;
+        result_cache_put_determinant(&key, response->value);
+    }
+}
+
+// Routed by find_eigenvalues_auto, like the menu and the script eig command.
+static int serve_eigen(const server_request_t* request, server_response_t* response) {
+    matrix_t* matrix = operand(request->a, response);
+    if (!matrix) return -1;
+    if (matrix->rows != matrix->cols || request->k < 0 || request->k > matrix->rows) {
+        response->status = SERVER_E_ARGUMENT;
+        return -1;
+    }
+
+    int variant = request->k > 0 ? CACHE_EIGEN_TOP_K : CACHE_EIGEN_AUTO;
+    cache_key_t key = result_cache_key(CACHE_OP_EIGEN, variant, request->k, matrix, NULL);
+    eigen_t* eigenvalues = NULL;
+    int count = 0;
+    if (result_cache_get_eigen(&key, &eigenvalues, &count) != 0) {
+        int status = find_eigenvalues_auto(matrix, request->k, &eigenvalues, &count, NULL);
+        if (status != 0 || !eigenvalues) {
+            response->status = SERVER_E_FAILED;
+            return -1;
+        }
+        result_cache_put_eigen(&key, eigenvalues, count, matrix->rows);
+    }
+
+    double* pairs = (double*)malloc((size_t)count * 2 * sizeof(double) + 1);
+    int fd = -1;
+    if (pairs) {
+        for (int i = 0; i < count; i++) {
+            pairs[2 * i] = eigenvalues[i].eigenvalue;
+            pairs[2 * i + 1] = eigenvalues[i].eigenvalue_imag;
+        }
+        fd = payload_fd(pairs, (size_t)count * 2 * sizeof(double));
+        free(pairs);
+    }
+    free_eigen_results(eigenvalues, count);
+    if (fd < 0) {
+        response->status = SERVER_E_FAILED;
+        return -1;
+    }
+    response->count = count;
+    return fd;
+}
+
+// Runs one request. Returns a payload fd to pass back, or -1 for none.
+static int serve(const server_request_t* request, int fd, server_response_t* response) {
+    if (request->engine < ENGINE_AUTO || request->engine > ENGINE_OPENMP) {
+        response->status = SERVER_E_ARGUMENT;
+        return -1;
+    }
+
+    matrix_t* matrix;
+    switch ((server_op_t)request->op) {
+        case SERVER_OP_PING:
+            return -1;
+        case SERVER_OP_FIND: {
+            char name[SERVER_NAME_SIZE];
+            memcpy(name, request->name, sizeof(name));
+            name[sizeof(name) - 1] = '\0';
+            matrix = find_matrix_by_name(name);
+            if (matrix) describe(matrix, response);
+            else response->status = SERVER_E_NOT_FOUND;
+            return -1;
+        }
+        case SERVER_OP_PUT:
+            serve_put(request, fd, response);
+            return -1;
+        case SERVER_OP_GET: {
+            if (!(matrix = operand(request->a, response))) return -1;
+            describe(matrix, response);
+            int out = payload_fd(matrix->storage, (size_t)matrix->rows * matrix->stride * sizeof(double));
+            if (out < 0) response->status = SERVER_E_FAILED;
+            return out;
+        }
+        case SERVER_OP_ADD:
+        case SERVER_OP_SUBTRACT:
+        case SERVER_OP_MULTIPLY:
+            serve_binary(request, response);
+            return -1;
+        case SERVER_OP_TRANSPOSE:
+            if (!(matrix = operand(request->a, response))) return -1;
+            matrix = matrix_transpose(matrix);
+            if (matrix) register_result(matrix, request, response);
+            else response->status = SERVER_E_FAILED;
+            return -1;
+        case SERVER_OP_DETERMINANT:
+            serve_determinant(request, response);
+            return -1;
+        case SERVER_OP_EIGEN:
+            return serve_eigen(request, response);
+        case SERVER_OP_FREE:
+            if (release_matrix(request->a) != 0) response->status = SERVER_E_NOT_FOUND;
+            return -1;
+        case SERVER_OP_SHUTDOWN:
+            stop_requested = 1;
+            return -1;
+    }
+    response->status = SERVER_E_PROTOCOL;
+    return -1;
+}
+
+// Receives one message and at most one descriptor; extra descriptors are
+// closed. Returns the message size, 0 when the peer is gone, -1 when no
+// message is waiting.
+static ssize_t receive_request(int client, server_request_t* request, int* fd, int* truncated) {
+    union {
+        struct cmsghdr align;
+        char buffer[CMSG_SPACE(4 * sizeof(int))];
+    } control;
+    struct iovec iov = { request, sizeof(*request) };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    *fd = -1;
+    ssize_t got = recvmsg(client, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (got < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? -1 : 0;
+
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&message); c; c = CMSG_NXTHDR(&message, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+        int n = (int)((c->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int* fds = (int*)CMSG_DATA(c);
+        for (int i = 0; i < n; i++) {
+            if (*fd < 0) *fd = fds[i];
+            else close(fds[i]);
+        }
+    }
+    *truncated = (message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
+    return got;
+}
+
+static int send_response(int client, const server_response_t* response, int fd) {
+    union {
+        struct cmsghdr align;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = { (void*)response, sizeof(*response) };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    if (fd >= 0) {
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+        struct cmsghdr* c = CMSG_FIRSTHDR(&message);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    }
+    // A client that does not read its responses is dropped rather than
+    // allowed to stall everyone else.
+    return sendmsg(client, &message, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)sizeof(*response) ? 0 : -1;
+}
+
+// Serves up to SERVER_BURST queued requests. Returns -1 once the client
+// should be disconnected.
+static int serve_client(int client) {
+    for (int i = 0; i < SERVER_BURST; i++) {
+        server_request_t request;
+        int fd, truncated = 0;
+        ssize_t got = receive_request(client, &request, &fd, &truncated);
+        if (got < 0) return 0;
+        if (got == 0) return -1;
+
+        long long span = trace_begin();
+        double start = monotonic_seconds();
+        server_response_t response;
+        memset(&response, 0, sizeof(response));
+        response.magic = SERVER_MAGIC;
+        response.id = -1;
+
+        int out = -1;
+        if (truncated || got != (ssize_t)sizeof(request) || request.magic != SERVER_MAGIC) {
+            response.status = SERVER_E_PROTOCOL;
+        } else {
+            out = serve(&request, fd, &response);
+        }
+        if (fd >= 0) close(fd);   // PUT keeps its own mapping
+
+        response.seconds = monotonic_seconds() - start;
+        stats.requests++;
+        stats.busy_seconds += response.seconds;
+        if (response.status != SERVER_OK) stats.failures++;
+        trace_end("server_request", span);
+
+        int sent = send_response(client, &response, out);
+        if (out >= 0) close(out);
+        if (sent != 0) return -1;
+    }
+    return 0;
+}
+
+static void accept_clients(int listener, int epoll_fd) {
+    while (1) {
+        int client = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0) return;
+        int slot = 0;
+        while (slot < SERVER_MAX_CLIENTS && clients[slot] >= 0) slot++;
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)slot;
+        if (slot == SERVER_MAX_CLIENTS || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &event) != 0) {
+            close(client);
+            continue;
+        }
+        clients[slot] = client;
+        client_count++;
+        stats.connections++;
+        if (client_count > stats.peak_clients) stats.peak_clients = client_count;
+    }
+}
+
+static void close_client(int slot) {
+    close(clients[slot]);   // also removes it from the epoll set
+    clients[slot] = -1;
+    client_count--;
+}
+
+static int open_listener(const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        printf("Server: socket path '%s' is too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    // Only a leftover socket is replaced, never some other file.
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        perror("Server: socket");
+        return -1;
+    }
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        printf("Server: cannot listen on '%s': %s\n", path, strerror(errno));
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+int server_run(const char* path) {
+    int listener = open_listener(path);
+    if (listener < 0) return -1;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = SERVER_MAX_CLIENTS;   // the listener's slot
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listener, &event) != 0) {
+        perror("Server: epoll");
+        if (epoll_fd >= 0) close(epoll_fd);
+        close(listener);
+        unlink(path);
+        return -1;
+    }
+
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) clients[i] = -1;
+    client_count = 0;
+    memset(&stats, 0, sizeof(stats));
+    stop_requested = 0;
+
+    // No SA_RESTART, so a signal wakes epoll_wait up to see the flag.
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stop_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+
+    printf("Server: listening on '%s' (%d matrices loaded)\n", path, matrix_count);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_EPOLL_EVENTS];
+    while (!stop_requested) {
+        int ready = epoll_wait(epoll_fd, events, SERVER_EPOLL_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("Server: epoll_wait");
+            break;
+        }
+        for (int i = 0; i < ready && !stop_requested; i++) {
+            uint32_t slot = events[i].data.u32;
+            if (slot == SERVER_MAX_CLIENTS) {
+                accept_clients(listener, epoll_fd);
+            } else if (clients[slot] >= 0) {
+                // Drain queued requests before honouring a hang-up.
+                int keep = (events[i].events & EPOLLIN) ? serve_client(clients[slot]) == 0
+                                                         : !(events[i].events & (EPOLLHUP | EPOLLERR));
+                if (!keep) close_client((int)slot);
+            }
+        }
+    }
+
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (clients[i] >= 0) close_client(i);
+    }
+    close(epoll_fd);
+    close(listener);
+    unlink(path);
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+
+    printf("Server: %lu requests (%lu failed) over %lu connections, peak %d concurrent",
+           stats.requests, stats.failures, stats.connections, stats.peak_clients);
+    if (stats.requests > 0) printf(", %.1f us mean service time", stats.busy_seconds / stats.requests * 1e6);
+    printf("\n");
+    return 0;
+}
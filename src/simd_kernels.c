@@ -0,0 +1,412 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/simd_kernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/* ---------------- Scalar fallback ---------------- */
+
+#define SCALAR_MR 4
+#define SCALAR_NR 8
+
+static void gemm_kernel_scalar(int kc, const double* Ap, const double* Bp,
+                               double* C, int ldc, int mr, int nr) {
+    double acc[SCALAR_MR][SCALAR_NR];
+    memset(acc, 0, sizeof(acc));
+
+    for (int p = 0; p < kc; p++) {
+        for (int i = 0; i < SCALAR_MR; i++) {
+            double a = Ap[i];
+            for (int j = 0; j < SCALAR_NR; j++) {
+                acc[i][j] += a * Bp[j];
+            }
+        }
+        Ap += SCALAR_MR;
+        Bp += SCALAR_NR;
+    }
+
+    for (int i = 0; i < mr; i++) {
+        double* c = C + (size_t)i * ldc;
+        for (int j = 0; j < nr; j++) {
+            c[j] += acc[i][j];
+        }
+    }
+}
+
+static void vector_add_scalar(const double* a, const double* b, double* c, int n) {
+    for (int i = 0; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+static void vector_sub_scalar(const double* a, const double* b, double* c, int n) {
+    for (int i = 0; i < n; i++) {
+        c[i] = a[i] - b[i];
+    }
+}
+
+static double vector_dot_scalar(const double* a, const double* b, int n) {
+    double result = 0.0;
+    for (int i = 0; i < n; i++) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+static void vector_axpy_scalar(double alpha, const double* x, double* y, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+#ifdef SIMD_X86
+
+/* ---------------- AVX2 + FMA (6x8 GEMM tile) ---------------- */
+
+#define AVX2_MR 6
+#define AVX2_NR 8
+
+#define AVX2_FMA_ROW(i) \
+    a = _mm256_broadcast_sd(Ap + i); \
+    c##i##0 = _mm256_fmadd_pd(a, b0, c##i##0); \
+    c##i##1 = _mm256_fmadd_pd(a, b1, c##i##1);
+
+#define AVX2_ADD_ROW(i) \
+    _mm256_storeu_pd(C + (size_t)i * ldc, \
+                     _mm256_add_pd(_mm256_loadu_pd(C + (size_t)i * ldc), c##i##0)); \
+    _mm256_storeu_pd(C + (size_t)i * ldc + 4, \
+                     _mm256_add_pd(_mm256_loadu_pd(C + (size_t)i * ldc + 4), c##i##1));
+
+#define AVX2_SPILL_ROW(i) \
+    _mm256_storeu_pd(tile + i * AVX2_NR, c##i##0); \
+    _mm256_storeu_pd(tile + i * AVX2_NR + 4, c##i##1);
+
+__attribute__((target("avx2,fma")))
+static void gemm_kernel_avx2(int kc, const double* Ap, const double* Bp,
+                             double* C, int ldc, int mr, int nr) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_loadu_pd(Bp);
+        __m256d b1 = _mm256_loadu_pd(Bp + 4);
+        __m256d a;
+        AVX2_FMA_ROW(0)
+        AVX2_FMA_ROW(1)
+        AVX2_FMA_ROW(2)
+        AVX2_FMA_ROW(3)
+        AVX2_FMA_ROW(4)
+        AVX2_FMA_ROW(5)
+        Ap += AVX2_MR;
+        Bp += AVX2_NR;
+    }
+
+    if (mr == AVX2_MR && nr == AVX2_NR) {
+        AVX2_ADD_ROW(0)
+        AVX2_ADD_ROW(1)
+        AVX2_ADD_ROW(2)
+        AVX2_ADD_ROW(3)
+        AVX2_ADD_ROW(4)
+        AVX2_ADD_ROW(5)
+        return;
+    }
+
+    double tile[AVX2_MR * AVX2_NR];
+    AVX2_SPILL_ROW(0)
+    AVX2_SPILL_ROW(1)
+    AVX2_SPILL_ROW(2)
+    AVX2_SPILL_ROW(3)
+    AVX2_SPILL_ROW(4)
+    AVX2_SPILL_ROW(5)
+    for (int i = 0; i < mr; i++) {
+        double* c = C + (size_t)i * ldc;
+        for (int j = 0; j < nr; j++) {
+            c[j] += tile[i * AVX2_NR + j];
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void vector_add_avx2(const double* a, const double* b, double* c, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(c + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(c + i + 4, _mm256_add_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(c + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void vector_sub_avx2(const double* a, const double* b, double* c, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(c + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(c + i + 4, _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(c + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) {
+        c[i] = a[i] - b[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static double vector_dot_avx2(const double* a, const double* b, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), s3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+    }
+    __m256d s = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double result = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < n; i++) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+__attribute__((target("avx2,fma")))
+static void vector_axpy_avx2(double alpha, const double* x, double* y, int n) {
+    __m256d va = _mm256_set1_pd(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+/* ---------------- AVX-512F (8x16 GEMM tile) ---------------- */
+
+#define AVX512_MR 8
+#define AVX512_NR 16
+
+#define AVX512_FMA_ROW(i) \
+    a = _mm512_set1_pd(Ap[i]); \
+    c##i##0 = _mm512_fmadd_pd(a, b0, c##i##0); \
+    c##i##1 = _mm512_fmadd_pd(a, b1, c##i##1);
+
+#define AVX512_ADD_ROW(i) \
+    _mm512_storeu_pd(C + (size_t)i * ldc, \
+                     _mm512_add_pd(_mm512_loadu_pd(C + (size_t)i * ldc), c##i##0)); \
+    _mm512_storeu_pd(C + (size_t)i * ldc + 8, \
+                     _mm512_add_pd(_mm512_loadu_pd(C + (size_t)i * ldc + 8), c##i##1));
+
+#define AVX512_SPILL_ROW(i) \
+    _mm512_storeu_pd(tile + i * AVX512_NR, c##i##0); \
+    _mm512_storeu_pd(tile + i * AVX512_NR + 8, c##i##1);
+
+__attribute__((target("avx512f")))
+static void gemm_kernel_avx512(int kc, const double* Ap, const double* Bp,
+                               double* C, int ldc, int mr, int nr) {
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+    __m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+    __m512d c60 = _mm512_setzero_pd(), c61 = _mm512_setzero_pd();
+    __m512d c70 = _mm512_setzero_pd(), c71 = _mm512_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_loadu_pd(Bp);
+        __m512d b1 = _mm512_loadu_pd(Bp + 8);
+        __m512d a;
+        AVX512_FMA_ROW(0)
+        AVX512_FMA_ROW(1)
+        AVX512_FMA_ROW(2)
+        AVX512_FMA_ROW(3)
+        AVX512_FMA_ROW(4)
+        AVX512_FMA_ROW(5)
+        AVX512_FMA_ROW(6)
+        AVX512_FMA_ROW(7)
+        Ap += AVX512_MR;
+        Bp += AVX512_NR;
+    }
+
+    if (mr == AVX512_MR && nr == AVX512_NR) {
+        AVX512_ADD_ROW(0)
+        AVX512_ADD_ROW(1)
+        AVX512_ADD_ROW(2)
+        AVX512_ADD_ROW(3)
+        AVX512_ADD_ROW(4)
+        AVX512_ADD_ROW(5)
+        AVX512_ADD_ROW(6)
+        AVX512_ADD_ROW(7)
+        return;
+    }
+
+    double tile[AVX512_MR * AVX512_NR];
+    AVX512_SPILL_ROW(0)
+    AVX512_SPILL_ROW(1)
+    AVX512_SPILL_ROW(2)
+    AVX512_SPILL_ROW(3)
+    AVX512_SPILL_ROW(4)
+    AVX512_SPILL_ROW(5)
+    AVX512_SPILL_ROW(6)
+    AVX512_SPILL_ROW(7)
+    for (int i = 0; i < mr; i++) {
+        double* c = C + (size_t)i * ldc;
+        for (int j = 0; j < nr; j++) {
+            c[j] += tile[i * AVX512_NR + j];
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void vector_add_avx512(const double* a, const double* b, double* c, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(c + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        __mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd(c + i, tail, _mm512_add_pd(_mm512_maskz_loadu_pd(tail, a + i),
+                                                         _mm512_maskz_loadu_pd(tail, b + i)));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void vector_sub_avx512(const double* a, const double* b, double* c, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(c + i, _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        __mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd(c + i, tail, _mm512_sub_pd(_mm512_maskz_loadu_pd(tail, a + i),
+                                                         _mm512_maskz_loadu_pd(tail, b + i)));
+    }
+}
+
+__attribute__((target("avx512f")))
+static double vector_dot_avx512(const double* a, const double* b, int n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), s1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), s0);
+    }
+    if (i < n) {
+        __mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i), s1);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f")))
+static void vector_axpy_avx512(double alpha, const double* x, double* y, int n) {
+    __m512d va = _mm512_set1_pd(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+    }
+    if (i < n) {
+        __mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd(y + i, tail, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(tail, x + i),
+                                                           _mm512_maskz_loadu_pd(tail, y + i)));
+    }
+}
+
+#endif /* SIMD_X86 */
+
+/* ---------------- Dispatch ---------------- */
+
+static const simd_kernels_t scalar_kernels = {
+    SIMD_SCALAR, "scalar", SCALAR_MR, SCALAR_NR, gemm_kernel_scalar,
+    vector_add_scalar, vector_sub_scalar, vector_dot_scalar, vector_axpy_scalar
+};
+
+#ifdef SIMD_X86
+static const simd_kernels_t avx2_kernels = {
+    SIMD_AVX2, "AVX2+FMA", AVX2_MR, AVX2_NR, gemm_kernel_avx2,
+    vector_add_avx2, vector_sub_avx2, vector_dot_avx2, vector_axpy_avx2
+};
+
+static const simd_kernels_t avx512_kernels = {
+    SIMD_AVX512, "AVX-512F", AVX512_MR, AVX512_NR, gemm_kernel_avx512,
+    vector_add_avx512, vector_sub_avx512, vector_dot_avx512, vector_axpy_avx512
+};
+#endif
+
+simd_kernels_t simd_kernels = {
+    SIMD_SCALAR, "scalar", SCALAR_MR, SCALAR_NR, gemm_kernel_scalar,
+    vector_add_scalar, vector_sub_scalar, vector_dot_scalar, vector_axpy_scalar
+};
+
+const char* simd_level_name(simd_level_t level) {
+    switch (level) {
+        case SIMD_AUTO: return "auto";
+        case SIMD_SCALAR: return "scalar";
+        case SIMD_AVX2: return "AVX2+FMA";
+        case SIMD_AVX512: return "AVX-512F";
+    }
+    return "unknown";
+}
+
+simd_level_t simd_detect_level(void) {
+    #ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SIMD_AVX2;
+    }
+    #endif
+    return SIMD_SCALAR;
+}
+
+int simd_initialize(simd_level_t requested) {
+    simd_level_t detected = simd_detect_level();
+    simd_level_t level = detected;
+
+    if (requested != SIMD_AUTO) {
+        if (requested > detected) {
+            printf("SIMD: %s not supported by this CPU, using %s\n",
+                   simd_level_name(requested), simd_level_name(detected));
+        } else {
+            level = requested;
+        }
+    }
+
+    simd_kernels = scalar_kernels;
+    #ifdef SIMD_X86
+    if (level == SIMD_AVX512) {
+        simd_kernels = avx512_kernels;
+    } else if (level == SIMD_AVX2) {
+        simd_kernels = avx2_kernels;
+    }
+    #endif
+
+    return simd_kernels.level;
+}
@@ -0,0 +1,168 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../include/trace.h"
+#include "../include/config.h"
+
+typedef struct {
+    const char* name;   // string literal; fork keeps its address valid in workers
+    long long start;    // CLOCK_MONOTONIC nanoseconds, comparable across processes
+    long long duration;
+} trace_event_t;
+
+typedef struct {
+    int pid;
+    int tid;
+    char label[32];
+    unsigned long long written;  // spans ever recorded; the ring keeps the last ones
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+typedef struct {
+    int rings_used;
+    long long origin;  // trace_init time, subtracted from every timestamp
+    trace_ring_t rings[TRACE_MAX_RINGS];
+} trace_region_t;
+
+int trace_active = 0;
+static trace_region_t* region = NULL;
+static int initialized = 0;  // rings claimed by threads are never re-mapped
+static char trace_path[MAX_FILENAME];
+static const char* child_label = NULL;
+static __thread trace_ring_t* thread_ring = NULL;
+
+static long long now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+int trace_init(const char* path) {
+    if (!path || !path[0] || initialized) return 0;
+
+    // Shared and anonymous: pages are only backed once a ring is written.
+    void* base = mmap(NULL, sizeof(trace_region_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        printf("Trace: cannot map %zu MB of ring buffers\n", sizeof(trace_region_t) >> 20);
+        return -1;
+    }
+    region = (trace_region_t*)base;
+    initialized = 1;
+    region->rings_used = 0;
+    region->origin = now_ns();
+    strncpy(trace_path, path, sizeof(trace_path) - 1);
+    trace_path[sizeof(trace_path) - 1] = '\0';
+    trace_active = 1;
+    return 0;
+}
+
+void trace_fork_child(const char* label) {
+    thread_ring = NULL;
+    child_label = label;
+}
+
+// First span of a thread: claim the next free ring. Claims race between
+// threads and worker processes, hence the atomic add on shared memory.
+static trace_ring_t* claim_ring(void) {
+    int slot = __sync_fetch_and_add(&region->rings_used, 1);
+    if (slot >= TRACE_MAX_RINGS) return NULL;
+
+    trace_ring_t* ring = &region->rings[slot];
+    ring->pid = (int)getpid();
+    ring->tid = (int)syscall(SYS_gettid);
+    ring->written = 0;
+    if (ring->tid != ring->pid) {
+        int thread = 0;
+        #ifdef _OPENMP
+        thread = omp_get_thread_num();
+        #endif
+        snprintf(ring->label, sizeof(ring->label), "OpenMP thread %d", thread);
+    } else {
+        snprintf(ring->label, sizeof(ring->label), "%s", child_label ? child_label : "main");
+    }
+    return ring;
+}
+
+long long trace_begin(void) {
+    return trace_active ? now_ns() : 0;
+}
+
+void trace_end(const char* name, long long start) {
+    if (!start || !trace_active) return;
+    long long end = now_ns();
+    if (!thread_ring) {
+        thread_ring = claim_ring();
+        if (!thread_ring) return;
+    }
+    trace_event_t* event = &thread_ring->events[thread_ring->written % TRACE_RING_EVENTS];
+    event->name = name;
+    event->start = start;
+    event->duration = end - start;
+    thread_ring->written++;
+}
+
+static void write_metadata(FILE* file, const trace_ring_t* ring, int* first) {
+    if (ring->tid == ring->pid) {
+        fprintf(file, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s (%d)\"}}",
+                *first ? "" : ",", ring->pid, ring->label, ring->pid);
+        *first = 0;
+    }
+    fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            *first ? "" : ",", ring->pid, ring->tid, ring->label);
+    *first = 0;
+}
+
+int trace_flush(void) {
+    if (!region) return 0;
+    trace_active = 0;
+
+    FILE* file = fopen(trace_path, "w");
+    if (!file) {
+        printf("Trace: cannot write '%s'\n", trace_path);
+        return -1;
+    }
+
+    int rings = region->rings_used < TRACE_MAX_RINGS ? region->rings_used : TRACE_MAX_RINGS;
+    int spans = 0;
+    unsigned long long dropped = 0;
+    int first = 1;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (int r = 0; r < rings; r++) {
+        const trace_ring_t* ring = &region->rings[r];
+        write_metadata(file, ring, &first);
+
+        unsigned long long kept = ring->written < TRACE_RING_EVENTS ? ring->written : TRACE_RING_EVENTS;
+        dropped += ring->written - kept;
+        for (unsigned long long i = ring->written - kept; i < ring->written; i++) {
+            const trace_event_t* event = &ring->events[i % TRACE_RING_EVENTS];
+            // Trace-event timestamps are microseconds.
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"matrix\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                          "\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, ring->pid, ring->tid,
+                    (event->start - region->origin) * 1e-3, event->duration * 1e-3);
+            spans++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Trace: %d spans from %d threads/processes written to '%s'", spans, rings, trace_path);
+    if (dropped > 0) printf(" (%llu oldest spans overwritten)", dropped);
+    if (region->rings_used > TRACE_MAX_RINGS) {
+        printf(" (%d threads/processes not traced)", region->rings_used - TRACE_MAX_RINGS);
+    }
+    printf("\n");
+
+    munmap(region, sizeof(trace_region_t));
+    region = NULL;
+    return spans;
+}